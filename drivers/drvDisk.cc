@@ -16,13 +16,15 @@
 
 //
 
-//	Use a semaphore to synchronize the interrupt handlers with the
+//	The physical disk can only handle one operation at a time, so
 
-//	pending requests.  And, because the physical disk can only
+//	the requests are queued in the driver.  The disk interrupt
 
-//	handle one operation at a time, use a lock to enforce mutual
+//	handler wakes up the thread waiting for the request just served,
 
-//	exclusion.
+//	and sends the next request to the disk, in the order chosen by
+
+//	the DiskScheduling entry of the configuration file.
 
 */
 
@@ -36,6 +38,14 @@
 
 #include "drivers/drvDisk.h"
 
+#include "kernel/scheduler.h"
+
+#include "kernel/system.h"
+
+#include "utility/config.h"
+
+#include "utility/stats.h"
+
 
 
 //----------------------------------------------------------------------
@@ -96,22 +106,34 @@ void DiskSwapRequestDone()
 
 //	initializing the physical disk.
 
+//
+
+//	\param driverName name of the driver, for debugging
+
+//	\param theDisk the disk driven
+
 */
 
 //----------------------------------------------------------------------
 
 
 
-DriverDisk::DriverDisk(char* sem_name, char *lock_name, Disk* theDisk)
+DriverDisk::DriverDisk(char* driverName, Disk* theDisk)
 
 {
 
-    semaphore = new Semaphore((char*)sem_name, 0);
-
-    lock = new Lock((char*)lock_name);
+    name = driverName;
 
     disk = theDisk;
 
+    queue = NULL;
+
+    current = NULL;
+
+    numRequests = 0;
+
+    headSector = 0;
+
 }
 
 
@@ -134,9 +156,27 @@ DriverDisk::~DriverDisk()
 
 {
 
-    delete lock;
+    // Requests still pending when Nachos halts
+
+    while (queue != NULL) {
+
+	DiskRequest request = queue;
+
+	queue = queue->next;
+
+	delete request;
+
+    }
 
-    delete semaphore;
+    while (current != NULL) {
+
+	DiskRequest request = current;
+
+	current = current->next;
+
+	delete request;
+
+    }
 
 }
 
@@ -168,19 +208,11 @@ DriverDisk::ReadSector(int sectorNumber, char* data)
 
 {
 
-    DEBUG('d', (char*)"[sdisk] rd req\n");
-
-    lock->Acquire();			// only one disk I/O at a time
+    DEBUG('d', (char*)"[%s] rd req\n", name);
 
-    disk->ReadRequest(sectorNumber, data);
+    Wait(Submit(sectorNumber, data, false));
 
-    DEBUG('d', (char*)"[sdisk] rd req: wait irq\n");
-
-    semaphore->P();			// wait for interrupt
-
-    DEBUG('d', (char*)"[sdisk] rd req: wait irq OK\n");
-
-    lock->Release();
+    DEBUG('d', (char*)"[%s] rd req: wait irq OK\n", name);
 
 }
 
@@ -212,19 +244,419 @@ DriverDisk::WriteSector(int sectorNumber, char* data)
 
 {
 
-    DEBUG('d', (char*)"[sdisk] wr req\n");
+    DEBUG('d', (char*)"[%s] wr req\n", name);
+
+    Wait(Submit(sectorNumber, data, true));
+
+    DEBUG('d', (char*)"[%s] wr req: wait irq OK\n", name);
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// DriverDisk::Submit
+
+/*! 	Queue a request to read or write consecutive disk sectors, and
+
+//	return without waiting for it. The buffer must be kept until the
+
+//	request is given to Wait.
+
+//
+
+//	\param sectorNumber the first disk sector to read or write
+
+//	\param data the buffer of the sectors contents
+
+//	\param writing true to write the sectors, false to read them
+
+//	\param numSectors the number of sectors
+
+//	\return the completion handle of the request
+
+*/
+
+//----------------------------------------------------------------------
+
+
+
+DiskRequest
+
+DriverDisk::Submit(int sectorNumber, char* data, bool writing,
+
+		   int numSectors)
+
+{
+
+    DiskRequest request = new struct diskreq_c;
+
+    DiskRequest *last;
+
+
+
+    request->sector = sectorNumber;
+
+    request->numSectors = numSectors;
+
+    request->data = data;
+
+    request->writing = writing;
+
+    request->done = false;
+
+    request->waiter = NULL;
+
+    request->next = NULL;
+
+
+
+    IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+
+    for (last = &queue; *last != NULL; last = &(*last)->next)
+
+	;
+
+    *last = request;
+
+    numRequests++;
+
+    g_stats->incrDiskSubmits(numRequests);
+
+    if (current == NULL)
+
+	Dispatch();
+
+    g_machine->interrupt->SetStatus(oldLevel);
+
+    return request;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// DriverDisk::Wait
+
+/*! 	Wait until a submitted request has been served, and free its
+
+//	handle.
+
+//
+
+//	\param request the completion handle returned by Submit
+
+*/
+
+//----------------------------------------------------------------------
+
+
+
+void
+
+DriverDisk::Wait(DiskRequest request)
+
+{
+
+    IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+
+    if (!request->done) {
+
+	DEBUG('d', (char*)"[%s] wait irq for sector %d\n", name,
+
+	      request->sector);
+
+	request->waiter = g_current_thread;
+
+	g_current_thread->Sleep();
+
+    }
+
+    ASSERT(request->done);
 
-    lock->Acquire();			// only one disk I/O at a time
+    g_machine->interrupt->SetStatus(oldLevel);
 
-    disk->WriteRequest(sectorNumber, data);
+    delete request;
 
-    DEBUG('d', (char*)"[sdisk] wr req: wait irq...\n");
+}
+
+
+
+//----------------------------------------------------------------------
 
-    semaphore->P();			// wait for interrupt
+// DriverDisk::Poll
 
-    DEBUG('d', (char*)"[sdisk] wr req: wait irq OK\n");
+/*! 	Wait until a submitted request has been served, and free its
 
-    lock->Release();
+//	handle, when Nachos halts and no thread may sleep any more: the
+
+//	pending interrupts are run until the request is done.
+
+//
+
+//	\param request the completion handle returned by Submit
+
+*/
+
+//----------------------------------------------------------------------
+
+
+
+void
+
+DriverDisk::Poll(DiskRequest request)
+
+{
+
+    IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+
+    while (!request->done)
+
+	g_machine->interrupt->Idle();
+
+    g_machine->interrupt->SetStatus(oldLevel);
+
+    delete request;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// SeekDistance
+
+/*! 	Distance used to order the requests: the distance to the disk
+
+//	head for SSTF, the distance travelled by the head sweeping up
+
+//	the disk for C-LOOK.
+
+//
+
+//	\param sector sector of a request
+
+//	\param head sector of the disk head
+
+*/
+
+//----------------------------------------------------------------------
+
+
+
+static int
+
+SeekDistance(int sector, int head)
+
+{
+
+    switch (g_cfg->DiskScheduling) {
+
+    case DISK_SCHED_SSTF:
+
+	return abs(sector - head);
+
+    case DISK_SCHED_CLOOK:
+
+	return (sector >= head) ? sector - head : sector - head + NUM_SECTORS;
+
+    default:
+
+	return 0;
+
+    }
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// DriverDisk::Blocked
+
+/*! 	Return true if a queued request overlaps the sectors of an
+
+//	earlier queued request, and must be served after it.
+
+//
+
+//	\param request a request of the queue
+
+*/
+
+//----------------------------------------------------------------------
+
+
+
+bool
+
+DriverDisk::Blocked(DiskRequest request)
+
+{
+
+    for (DiskRequest earlier = queue; earlier != request;
+
+	 earlier = earlier->next)
+
+	if ((earlier->sector < request->sector + request->numSectors)
+
+	    && (request->sector < earlier->sector + earlier->numSectors))
+
+	    return true;
+
+    return false;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// DriverDisk::Dispatch
+
+/*! 	Send the best queued request to the disk, which must be idle,
+
+//	together with the queued requests of the same direction on the
+
+//	sectors following it. A request waits for the earlier requests
+
+//	on the same sectors. Called with interrupts disabled.
+
+*/
+
+//----------------------------------------------------------------------
+
+
+
+void
+
+DriverDisk::Dispatch()
+
+{
+
+    DiskRequest best = NULL;
+
+    DiskRequest *bestLink = NULL;
+
+    DiskRequest *link, last;
+
+    int numSectors;
+
+
+
+    ASSERT(current == NULL);
+
+    for (link = &queue; *link != NULL; link = &(*link)->next) {
+
+	if (Blocked(*link))
+
+	    continue;
+
+	if ((best == NULL) || (SeekDistance((*link)->sector, headSector)
+
+			       < SeekDistance(best->sector, headSector))) {
+
+	    best = *link;
+
+	    bestLink = link;
+
+	}
+
+	if (g_cfg->DiskScheduling == DISK_SCHED_FIFO)
+
+	    break;
+
+    }
+
+    ASSERT(best != NULL);
+
+    *bestLink = best->next;
+
+    best->next = NULL;
+
+    current = last = best;
+
+    numSectors = best->numSectors;
+
+
+
+    // Coalesce the requests continuing the run
+
+    link = &queue;
+
+    while (*link != NULL) {
+
+	if (((*link)->writing == best->writing)
+
+	    && ((*link)->sector == best->sector + numSectors)
+
+	    && !Blocked(*link)) {
+
+	    last->next = *link;
+
+	    last = *link;
+
+	    *link = last->next;
+
+	    last->next = NULL;
+
+	    numSectors += last->numSectors;
+
+	    link = &queue;
+
+	}
+
+	else
+
+	    link = &(*link)->next;
+
+    }
+
+
+
+    // Scatter-gather list of the buffers of the run
+
+    char **buffers = new char*[numSectors];
+
+    int i = 0;
+
+    for (DiskRequest request = current; request != NULL;
+
+	 request = request->next)
+
+	for (int j = 0; j < request->numSectors; j++)
+
+	    buffers[i++] = request->data + j * g_cfg->SectorSize;
+
+
+
+    g_stats->incrDiskRequests(abs(best->sector / SECTORS_PER_TRACK
+
+				  - headSector / SECTORS_PER_TRACK),
+
+			      numSectors);
+
+    headSector = best->sector + numSectors - 1;
+
+    DEBUG('d', (char*)"[%s] %s %d sectors from sector %d\n", name,
+
+	  best->writing ? "writing" : "reading", numSectors, best->sector);
+
+
+
+    // The disk transfers the data right away
+
+    if (best->writing)
+
+	disk->WriteRequest(best->sector, buffers, numSectors);
+
+    else
+
+	disk->ReadRequest(best->sector, buffers, numSectors);
+
+    delete [] buffers;
 
 }
 
@@ -234,9 +666,9 @@ DriverDisk::WriteSector(int sectorNumber, char* data)
 
 // DriverDisk::RequestDone
 
-/*! 	Disk interrupt handler. Wake up any thread waiting for the disk
+/*! 	Disk interrupt handler. Wake up the threads waiting for the disk
 
-//	request to finish.
+//	requests to finish, and send the next request to the disk.
 
 */
 
@@ -248,11 +680,31 @@ void
 
 DriverDisk::RequestDone()
 
-{ 
+{
+
+  DEBUG('d', (char*)"[%s] req done\n", name);
+
+  ASSERT(current != NULL);
+
+  while (current != NULL) {
+
+    DiskRequest request = current;
+
+    current = current->next;
+
+    numRequests--;
+
+    request->done = true;
+
+    if (request->waiter != NULL)
+
+      g_scheduler->ReadyToRun(request->waiter);
+
+  }
 
-  DEBUG('d', (char*)"[sdisk] req done\n");
+  if (queue != NULL)
 
-  semaphore->V();
+    Dispatch();
 
 }
 
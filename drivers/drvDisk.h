@@ -32,9 +32,41 @@
 
 
 
-class Semaphore;
+class Thread;
 
-class Lock;
+
+
+/*! \brief A request queued in the disk driver.
+
+//
+
+// Returned by DriverDisk::Submit as a completion handle, to be given
+
+// back to DriverDisk::Wait (which frees it) once and only once.
+
+*/
+
+struct diskreq_c {
+
+  int sector;			//!< First sector to read or write
+
+  int numSectors;		//!< Number of consecutive sectors
+
+  char *data;			//!< Buffer of the sectors, kept until Wait
+
+  bool writing;			//!< true for a write request
+
+  bool done;			//!< true once the disk has served it
+
+  Thread *waiter;		//!< Thread sleeping in Wait, if any
+
+  struct diskreq_c *next;	//!< Next request, in submission order
+
+};
+
+
+
+typedef struct diskreq_c *DiskRequest;
 
 
 
@@ -62,13 +94,43 @@ class Lock;
 
 // returning.
 
+//
+
+// The requests are queued in the driver, and the interrupt handler
+
+// sends the next one to the disk as soon as the previous one is done.
+
+// The order in which they are served is chosen by the DiskScheduling
+
+// entry of the configuration file:
+
+// - FIFO: submission order
+
+// - SSTF: shortest seek first, the request nearest to the disk head
+
+// - CLOOK: the head sweeps up the sectors, then jumps back to the
+
+//   lowest requested one
+
+//
+
+// Requests on the same sector are always served in submission order.
+
+//
+
+// A request may cover several consecutive sectors. When the disk is
+
+// free, the driver also coalesces the queued requests of the same
+
+// direction following the one it serves into a single disk transfer.
+
 */
 
 class DriverDisk {
 
   public:
 
-  DriverDisk(char* sem_name, char* lock_name, Disk* theDisk); 
+  DriverDisk(char* name, Disk* theDisk);
 
                                         // Constructor. Initializes the disk
 
@@ -90,6 +152,24 @@ class DriverDisk {
 
     
 
+    DiskRequest Submit(int sectorNumber, char* data, bool writing,
+
+		       int numSectors = 1);
+
+					// Queue a read/write request of
+
+					// numSectors consecutive sectors
+
+					// and return immediately
+
+    void Wait(DiskRequest request);	// Wait for a request to be served
+
+    void Poll(DiskRequest request);	// Same, without sleeping, when
+
+					// Nachos halts
+
+
+
     void RequestDone();			// Called by the disk device interrupt
 
 					// handler, to signal that the
@@ -100,18 +180,42 @@ class DriverDisk {
 
 private:
 
-  Semaphore *semaphore; 		/*!< To synchronize requesting thread 
+  void Dispatch();			/*!< Send the next request to the disk
 
-					     with the interrupt handler
+					*/
+
+  bool Blocked(DiskRequest request);	/*!< true if the request must wait for
+
+					     an earlier one
 
 					*/
 
-  Lock *lock;		  		/*!< Mutual exclusion on the disk device
+  char *name;				/*!< Name of the driver, for debugging
 
 					*/
 
   Disk *disk;                         /* The disk */
 
+  DiskRequest queue;			/*!< Requests not sent to the disk yet,
+
+					     in submission order
+
+					*/
+
+  DiskRequest current;			/*!< Requests served by the disk, in
+
+					     sector order, or NULL
+
+					*/
+
+  int numRequests;			/*!< Requests queued or being served
+
+					*/
+
+  int headSector;			/*!< Sector of the last request sent
+
+					*/
+
 };
 
 
@@ -0,0 +1,948 @@
+/*! \file bufcache.cc
+
+// \brief Routines of the sector buffer cache of the file system
+
+//
+
+// The cache has numBlocks blocks of one sector. The block caching a
+
+// sector is found through the blockOf table, indexed by the sector
+
+// number. The blocks in use are linked in the A1in (2Q only) and Am
+
+// queues, in their order of eviction.
+
+//
+
+// The operations are serialized by a lock, held across the disk
+
+// transfers they wait for.
+
+//
+
+//  Copyright (c) 1999-2000 INSA de Rennes.
+
+//  All rights reserved.
+
+//  See copyright_insa.h for copyright notice and limitation
+
+//  of liability and disclaimer of warranty provisions.
+
+*/
+
+
+
+#include <string.h>
+
+#include "kernel/system.h"
+
+#include "utility/config.h"
+
+#include "utility/stats.h"
+
+#include "filesys/bufcache.h"
+
+
+
+//----------------------------------------------------------------------
+
+// BufferCache::BufferCache
+
+/*! Create an empty cache
+
+//
+
+// \param driver driver of the disk to cache
+
+// \param size number of sectors of the cache (0 disables it)
+
+*/
+
+//----------------------------------------------------------------------
+
+BufferCache::BufferCache(DriverDisk *driver, int size)
+
+{
+
+  disk = driver;
+
+  numBlocks = size;
+
+  numPinned = 0;
+
+  lock = new Lock((char *)"buffer cache");
+
+
+
+  data = new char[numBlocks * g_cfg->SectorSize];
+
+  sectorOf = new int[numBlocks];
+
+  dirty = new bool[numBlocks];
+
+  pins = new int[numBlocks];
+
+  queueOf = new int[numBlocks];
+
+  prev = new int[numBlocks];
+
+  next = new int[numBlocks];
+
+  for (int i = 0; i < numBlocks; i++) {
+
+    sectorOf[i] = -1;
+
+    dirty[i] = false;
+
+    pins[i] = 0;
+
+    queueOf[i] = QUEUE_NONE;
+
+  }
+
+  for (int q = 0; q < 3; q++) {
+
+    head[q] = tail[q] = -1;
+
+    length[q] = 0;
+
+  }
+
+  blockOf = new int[NUM_SECTORS];
+
+  ghost = new int[NUM_SECTORS];
+
+  for (int i = 0; i < NUM_SECTORS; i++) {
+
+    blockOf[i] = -1;
+
+    ghost[i] = 0;
+
+  }
+
+
+
+  // 2Q: A1out remembers as many sectors as half of the cache
+
+  numGhosts = numBlocks / 2 + 1;
+
+  ghosts = new int[numGhosts];
+
+  ghostHead = ghostCount = 0;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// BufferCache::~BufferCache
+
+//! Delete the cache. The dirty blocks must have been flushed.
+
+//----------------------------------------------------------------------
+
+BufferCache::~BufferCache()
+
+{
+
+  delete lock;
+
+  delete [] data;
+
+  delete [] sectorOf;
+
+  delete [] dirty;
+
+  delete [] pins;
+
+  delete [] queueOf;
+
+  delete [] prev;
+
+  delete [] next;
+
+  delete [] blockOf;
+
+  delete [] ghost;
+
+  delete [] ghosts;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// BufferCache::ReadSector
+
+/*! Read a sector through the cache
+
+//
+
+// \param sector the sector to read
+
+// \param buf the buffer to hold the contents of the sector
+
+*/
+
+//----------------------------------------------------------------------
+
+void
+
+BufferCache::ReadSector(int sector, char *buf)
+
+{
+
+  ReadSectors(sector, buf, 1);
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// BufferCache::WriteSector
+
+/*! Write a sector through the cache: it only reaches the disk
+
+// when it is evicted or flushed.
+
+//
+
+// \param sector the sector to write
+
+// \param buf the new contents of the sector
+
+*/
+
+//----------------------------------------------------------------------
+
+void
+
+BufferCache::WriteSector(int sector, char *buf)
+
+{
+
+  WriteSectors(sector, buf, 1);
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// BufferCache::ReadSectors
+
+/*! Read consecutive sectors through the cache. The runs of missing
+
+// sectors are read by one disk request each, directly in the buffer
+
+// of the caller, and then copied in the cache.
+
+//
+
+// \param sector the first sector to read
+
+// \param buf the buffer to hold the contents of the sectors
+
+// \param numSectors the number of sectors to read
+
+*/
+
+//----------------------------------------------------------------------
+
+void
+
+BufferCache::ReadSectors(int sector, char *buf, int numSectors)
+
+{
+
+  int sectorSize = g_cfg->SectorSize;
+
+
+
+  if (numBlocks == 0) {
+
+    disk->Wait(disk->Submit(sector, buf, false, numSectors));
+
+    return;
+
+  }
+
+
+
+  DiskRequest requests[numSectors];
+
+  int first[numSectors], count[numSectors];
+
+  int numRequests = 0;
+
+  int i, run;
+
+
+
+  lock->Acquire();
+
+  for (i = 0; i < numSectors; i += run) {
+
+    int block = Lookup(sector + i);
+
+    if (block >= 0) {
+
+      g_stats->incrCacheHits();
+
+      memcpy(buf + i * sectorSize, data + block * sectorSize, sectorSize);
+
+      Touch(block);
+
+      run = 1;
+
+      continue;
+
+    }
+
+    for (run = 1; (i + run < numSectors) && (Lookup(sector + i + run) < 0);
+
+	 run++)
+
+      ;
+
+    g_stats->incrCacheMisses(run);
+
+    requests[numRequests] = disk->Submit(sector + i, buf + i * sectorSize,
+
+					 false, run);
+
+    first[numRequests] = i;
+
+    count[numRequests] = run;
+
+    numRequests++;
+
+  }
+
+
+
+  for (int r = 0; r < numRequests; r++) {
+
+    disk->Wait(requests[r]);
+
+    for (i = first[r]; i < first[r] + count[r]; i++) {
+
+      int block = Allocate(sector + i);
+
+      if (block >= 0)
+
+	memcpy(data + block * sectorSize, buf + i * sectorSize, sectorSize);
+
+    }
+
+  }
+
+  lock->Release();
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// BufferCache::WriteSectors
+
+/*! Write consecutive sectors through the cache. They only reach the
+
+// disk when they are evicted or flushed.
+
+//
+
+// \param sector the first sector to write
+
+// \param buf the new contents of the sectors
+
+// \param numSectors the number of sectors to write
+
+*/
+
+//----------------------------------------------------------------------
+
+void
+
+BufferCache::WriteSectors(int sector, char *buf, int numSectors)
+
+{
+
+  int sectorSize = g_cfg->SectorSize;
+
+
+
+  if (numBlocks == 0) {
+
+    disk->Wait(disk->Submit(sector, buf, true, numSectors));
+
+    return;
+
+  }
+
+
+
+  lock->Acquire();
+
+  for (int i = 0; i < numSectors; i++) {
+
+    int block = Lookup(sector + i);
+
+    if (block >= 0)
+
+      Touch(block);
+
+    else {
+
+      // Whole sectors are written: nothing to read
+
+      block = Allocate(sector + i);
+
+      if (block < 0) {
+
+	disk->WriteSector(sector + i, buf + i * sectorSize);
+
+	continue;
+
+      }
+
+    }
+
+    memcpy(data + block * sectorSize, buf + i * sectorSize, sectorSize);
+
+    if (!dirty[block]) {
+
+      dirty[block] = true;
+
+      g_stats->incrCacheDirtied();
+
+    }
+
+  }
+
+  lock->Release();
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// BufferCache::Pin
+
+/*! Keep a sector in the cache until it is unpinned, reading it if it
+
+// is not cached yet. At most half of the cache may be pinned.
+
+//
+
+// \param sector the sector to pin
+
+// \return true if the sector was pinned
+
+*/
+
+//----------------------------------------------------------------------
+
+bool
+
+BufferCache::Pin(int sector)
+
+{
+
+  bool pinned = false;
+
+
+
+  lock->Acquire();
+
+  if (numPinned < numBlocks / 2) {
+
+    int block = Lookup(sector);
+
+    if (block < 0) {
+
+      g_stats->incrCacheMisses(1);
+
+      block = Allocate(sector);
+
+      if (block >= 0)
+
+	disk->ReadSector(sector, data + block * g_cfg->SectorSize);
+
+    }
+
+    if (block >= 0) {
+
+      if (pins[block]++ == 0)
+
+	numPinned++;
+
+      pinned = true;
+
+    }
+
+  }
+
+  lock->Release();
+
+  return pinned;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// BufferCache::Unpin
+
+/*! Let a pinned sector be evicted again
+
+//
+
+// \param sector the sector to unpin
+
+*/
+
+//----------------------------------------------------------------------
+
+void
+
+BufferCache::Unpin(int sector)
+
+{
+
+  int block = Lookup(sector);
+
+
+
+  ASSERT((block >= 0) && (pins[block] > 0));
+
+  if (--pins[block] == 0)
+
+    numPinned--;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// BufferCache::Flush
+
+//! Write the dirty sectors back to the disk (Sync system call).
+
+//----------------------------------------------------------------------
+
+void
+
+BufferCache::Flush()
+
+{
+
+  lock->Acquire();
+
+  WriteBack(false);
+
+  lock->Release();
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// BufferCache::FlushAtHalt
+
+/*! Write the dirty sectors back to the disk when Nachos halts. The
+
+// threads cannot sleep any more, and the one holding the lock will
+
+// not run again, so the lock is ignored.
+
+*/
+
+//----------------------------------------------------------------------
+
+void
+
+BufferCache::FlushAtHalt()
+
+{
+
+  WriteBack(true);
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// BufferCache::WriteBack
+
+/*! Write all the dirty blocks back. They are all submitted before
+
+// waiting for them, so that the disk driver can sort and coalesce
+
+// them.
+
+//
+
+// \param halting true to poll the disk instead of sleeping
+
+*/
+
+//----------------------------------------------------------------------
+
+void
+
+BufferCache::WriteBack(bool halting)
+
+{
+
+  DiskRequest requests[numBlocks + 1];
+
+  int numRequests = 0;
+
+
+
+  for (int block = 0; block < numBlocks; block++) {
+
+    if (!dirty[block])
+
+      continue;
+
+    dirty[block] = false;
+
+    g_stats->incrCacheWritebacks();
+
+    requests[numRequests++] =
+
+      disk->Submit(sectorOf[block], data + block * g_cfg->SectorSize, true);
+
+  }
+
+  for (int r = 0; r < numRequests; r++) {
+
+    if (halting)
+
+      disk->Poll(requests[r]);
+
+    else
+
+      disk->Wait(requests[r]);
+
+  }
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// BufferCache::Lookup
+
+//! Return the block caching a sector, -1 if it is not cached
+
+//----------------------------------------------------------------------
+
+int
+
+BufferCache::Lookup(int sector)
+
+{
+
+  ASSERT((sector >= 0) && (sector < NUM_SECTORS));
+
+  return blockOf[sector];
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// BufferCache::Allocate
+
+/*! Give a block to a sector missing from the cache, evicting another
+
+// sector if needed (and writing it back if it is dirty). The contents
+
+// of the block must then be filled by the caller.
+
+//
+
+// \param sector the sector to cache
+
+// \return the block, or -1 if all the blocks are pinned
+
+*/
+
+//----------------------------------------------------------------------
+
+int
+
+BufferCache::Allocate(int sector)
+
+{
+
+  int block = ChooseVictim();
+
+
+
+  if (block < 0)
+
+    return -1;
+
+  if (sectorOf[block] >= 0) {
+
+    int old = sectorOf[block];
+
+    if (dirty[block]) {
+
+      // The lock keeps the block from being reused while written
+
+      g_stats->incrCacheWritebacks();
+
+      disk->WriteSector(old, data + block * g_cfg->SectorSize);
+
+      dirty[block] = false;
+
+    }
+
+    if (queueOf[block] == QUEUE_A1IN)
+
+      Remember(old);
+
+    blockOf[old] = -1;
+
+    Dequeue(block);
+
+  }
+
+  sectorOf[block] = sector;
+
+  blockOf[sector] = block;
+
+
+
+  // 2Q: a sector evicted from A1in and missed again is hot
+
+  if ((g_cfg->BufferCachePolicy == CACHE_2Q) && (ghost[sector] == 0))
+
+    Enqueue(block, QUEUE_A1IN);
+
+  else
+
+    Enqueue(block, QUEUE_AM);
+
+  return block;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// BufferCache::ChooseVictim
+
+/*! Return a block to give to a missing sector: a free block, or else
+
+// the first unpinned block of A1in if A1in holds more than a quarter
+
+// of the cache (2Q), or else the first unpinned block of Am.
+
+//
+
+// \return the block, or -1 if all the blocks are pinned
+
+*/
+
+//----------------------------------------------------------------------
+
+int
+
+BufferCache::ChooseVictim()
+
+{
+
+  int queues[2] = {QUEUE_AM, QUEUE_A1IN};
+
+
+
+  for (int block = 0; block < numBlocks; block++)
+
+    if (sectorOf[block] < 0)
+
+      return block;
+
+
+
+  if (length[QUEUE_A1IN] > numBlocks / 4) {
+
+    queues[0] = QUEUE_A1IN;
+
+    queues[1] = QUEUE_AM;
+
+  }
+
+  for (int q = 0; q < 2; q++)
+
+    for (int block = head[queues[q]]; block >= 0; block = next[block])
+
+      if (pins[block] == 0)
+
+	return block;
+
+  return -1;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// BufferCache::Touch
+
+/*! A cached block was referenced: it moves to the end of Am. With 2Q,
+
+// the blocks of A1in stay where they are, since references that close
+
+// to the first one do not make a sector hot.
+
+*/
+
+//----------------------------------------------------------------------
+
+void
+
+BufferCache::Touch(int block)
+
+{
+
+  if (queueOf[block] == QUEUE_A1IN)
+
+    return;
+
+  Dequeue(block);
+
+  Enqueue(block, QUEUE_AM);
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// BufferCache::Enqueue
+
+//! Append a block at the end of a queue
+
+//----------------------------------------------------------------------
+
+void
+
+BufferCache::Enqueue(int block, int queue)
+
+{
+
+  queueOf[block] = queue;
+
+  prev[block] = tail[queue];
+
+  next[block] = -1;
+
+  if (tail[queue] >= 0)
+
+    next[tail[queue]] = block;
+
+  else
+
+    head[queue] = block;
+
+  tail[queue] = block;
+
+  length[queue]++;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// BufferCache::Dequeue
+
+//! Remove a block from its queue
+
+//----------------------------------------------------------------------
+
+void
+
+BufferCache::Dequeue(int block)
+
+{
+
+  int queue = queueOf[block];
+
+
+
+  if (prev[block] >= 0)
+
+    next[prev[block]] = next[block];
+
+  else
+
+    head[queue] = next[block];
+
+  if (next[block] >= 0)
+
+    prev[next[block]] = prev[block];
+
+  else
+
+    tail[queue] = prev[block];
+
+  length[queue]--;
+
+  queueOf[block] = QUEUE_NONE;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// BufferCache::Remember
+
+//! Enter a sector evicted from A1in in A1out, forgetting the oldest one
+
+//----------------------------------------------------------------------
+
+void
+
+BufferCache::Remember(int sector)
+
+{
+
+  if (ghostCount == numGhosts) {
+
+    ghost[ghosts[ghostHead]]--;
+
+    ghostHead = (ghostHead + 1) % numGhosts;
+
+    ghostCount--;
+
+  }
+
+  ghosts[(ghostHead + ghostCount) % numGhosts] = sector;
+
+  ghostCount++;
+
+  ghost[sector]++;
+
+}
+
@@ -0,0 +1,196 @@
+/*! \file bufcache.h
+
+   \brief Sector buffer cache of the file system
+
+
+
+   The file system reads and writes its sectors (file headers and file
+
+   contents) through a cache of BufferCacheSize sectors, in front of
+
+   the disk driver. The writes are delayed: the dirty sectors go to the
+
+   disk when they are evicted, when the Sync system call is invoked,
+
+   and when Nachos halts.
+
+
+
+   The sectors to evict are chosen by the BufferCachePolicy entry of
+
+   the configuration file:
+
+   - LRU: the least recently used sector
+
+   - 2Q: the sectors read once go through a FIFO queue first, and
+
+     only the ones referenced again (or soon after their eviction)
+
+     enter the LRU queue, so that a large sequential transfer does not
+
+     flush the sectors used often
+
+
+
+   Pinned sectors (the metadata used by every file system operation)
+
+   are never evicted.
+
+
+
+    Copyright (c) 1999-2000 INSA de Rennes.
+
+    All rights reserved.
+
+    See copyright_insa.h for copyright notice and limitation
+
+    of liability and disclaimer of warranty provisions.
+
+*/
+
+
+
+#ifndef FS_BUFCACHE
+
+#define FS_BUFCACHE
+
+
+
+#include "drivers/drvDisk.h"
+
+#include "kernel/synch.h"
+
+
+
+/*! \brief Defines the sector buffer cache of the file system
+
+*/
+
+class BufferCache {
+
+public:
+
+  //! Create a cache of size sectors of a disk (0 disables it)
+
+  BufferCache(DriverDisk *driver, int size);
+
+
+
+  //! Delete the cache, which must have been flushed
+
+  ~BufferCache();
+
+
+
+  //! Read/write a sector through the cache
+
+  void ReadSector(int sector, char *data);
+
+  void WriteSector(int sector, char *data);
+
+
+
+  //! Read/write numSectors consecutive sectors through the cache
+
+  void ReadSectors(int sector, char *data, int numSectors);
+
+  void WriteSectors(int sector, char *data, int numSectors);
+
+
+
+  //! Keep a sector in the cache until it is unpinned. Returns false
+
+  //! if too many sectors are pinned already
+
+  bool Pin(int sector);
+
+  void Unpin(int sector);
+
+
+
+  //! Write the dirty sectors back to the disk
+
+  void Flush();
+
+
+
+  //! Write the dirty sectors back when Nachos halts: no thread may
+
+  //! sleep any more, so the disk interrupts are polled
+
+  void FlushAtHalt();
+
+
+
+private:
+
+  //! Queues of the cached sectors
+
+  enum {QUEUE_NONE, QUEUE_A1IN, QUEUE_AM};
+
+
+
+  int Lookup(int sector);               //!< Block of a cached sector, or -1
+
+  int Allocate(int sector);             //!< Block given to a sector missing
+
+  int ChooseVictim();                   //!< Unpinned block to evict, or -1
+
+  void Touch(int block);                //!< The block was referenced
+
+  void Enqueue(int block, int queue);   //!< Appends a block to a queue
+
+  void Dequeue(int block);              //!< Removes a block from its queue
+
+  void Remember(int sector);            //!< Enters an evicted sector in A1out
+
+  void WriteBack(bool halting);         //!< Writes the dirty blocks back
+
+
+
+  DriverDisk *disk;        //!< Driver of the disk cached
+
+  int numBlocks;           //!< Number of blocks of the cache
+
+  int numPinned;           //!< Number of pinned blocks
+
+  Lock *lock;              //!< Serializes the operations on the cache
+
+
+
+  char *data;              //!< Contents of the blocks
+
+  int *sectorOf;           //!< Sector cached in each block, -1 if none
+
+  bool *dirty;             //!< true if the block differs from the disk
+
+  int *pins;               //!< Number of pins of each block
+
+  int *queueOf;            //!< Queue of each block
+
+  int *prev, *next;        //!< Links of the blocks in their queue
+
+  int head[3], tail[3];    //!< First and last block of each queue
+
+  int length[3];           //!< Number of blocks in each queue
+
+  int *blockOf;            //!< Block caching each disk sector, -1 if none
+
+
+
+  int *ghost;              //!< Number of times each sector is in A1out (2Q)
+
+  int *ghosts;             //!< A1out: recently evicted sectors, FIFO order
+
+  int numGhosts;           //!< Size of A1out
+
+  int ghostHead;           //!< Oldest sector of A1out
+
+  int ghostCount;          //!< Number of sectors in A1out
+
+};
+
+
+
+#endif // FS_BUFCACHE
+
@@ -56,7 +56,7 @@
 
 #include "utility/config.h"
 
-#include "drivers/drvDisk.h"
+#include "filesys/bufcache.h"
 
 
 
@@ -66,6 +66,8 @@ FileHeader::FileHeader(void)
 
   dataSectors = NULL;
 
+  dirty = false;
+
 }
 
 
@@ -160,6 +162,8 @@ FileHeader::Allocate(BitMap *freeMap, int fileSize)
 
     dataSectors[i] = freeMap->Find();
 
+  dirty = true;
+
 
 
   return true;
@@ -246,6 +250,8 @@ FileHeader::reAllocate(BitMap *freeMap, int oldFileSize,int newFileSize)
 
   numHeaderSectors+= newnumHeaderSectors;    
 
+  dirty = true;
+
 
 
   return true;
@@ -298,7 +304,11 @@ FileHeader::Deallocate(BitMap *freeMap)
 
     }
 
-    
+
+
+    // The header sector is freed too: never write it back
+
+    dirty = false;
 
 }
 
@@ -342,7 +352,7 @@ FileHeader::FetchFrom(int sector)
 
   // and put it in the temporary buffer
 
-  g_disk_driver->ReadSector(sector, (char *)SectorImg);  
+  g_buffer_cache->ReadSector(sector, (char *)SectorImg);  
 
 
 
@@ -394,7 +404,7 @@ FileHeader::FetchFrom(int sector)
 
       memset(SectorImg, 0, g_cfg->SectorSize);
 
-      g_disk_driver->ReadSector(headerSectors[i],(char *)SectorImg);
+      g_buffer_cache->ReadSector(headerSectors[i],(char *)SectorImg);
 
 
 
@@ -412,6 +422,8 @@ FileHeader::FetchFrom(int sector)
 
     }
 
+  dirty = false;
+
 }
 
 
@@ -442,7 +454,7 @@ FileHeader::WriteBack(int sector)
 
 {
 
-  int SectorImg[DatasInSector];
+  int SectorImg[g_cfg->SectorSize / sizeof(int)];
 
   int i,j;
 
@@ -480,7 +492,7 @@ FileHeader::WriteBack(int sector)
 
   // Write the first header sector into disk
 
-  g_disk_driver->WriteSector(sector, (char *)SectorImg);
+  g_buffer_cache->WriteSector(sector, (char *)SectorImg);
 
 
 
@@ -504,10 +516,12 @@ FileHeader::WriteBack(int sector)
 
 	NextHeaderSector(SectorImg) = 0;
 
-      g_disk_driver->WriteSector(headerSectors[i],(char *)SectorImg);
+      g_buffer_cache->WriteSector(headerSectors[i],(char *)SectorImg);
 
     }
 
+  dirty = false;
+
 }
 
 
@@ -588,6 +602,8 @@ FileHeader::ChangeFileLength(int newsize)
 
   ASSERT(newsize <= MAX_FILE_LENGTH);
 
+  dirty = true;
+
   
 
 }
@@ -648,7 +664,7 @@ FileHeader::Print()
 
     for (i = k = 0; i < numSectors; i++) {
 
-	g_disk_driver->ReadSector(dataSectors[i], data);
+	g_buffer_cache->ReadSector(dataSectors[i], data);
 
         for (j = 0; (j < g_cfg->SectorSize) && (k < numBytes); j++, k++) {
 
@@ -716,6 +732,8 @@ FileHeader::SetFile()
 
   isdir=0;
 
+  dirty = true;
+
 }
 
 
@@ -740,5 +758,35 @@ FileHeader::SetDir()
 
   isdir=1;
 
+  dirty = true;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// FileHeader::IsDirty
+
+/*!    Test if the header was modified since it was fetched from or
+
+//     written back to the disk.
+
+//
+
+//     eturn true if the header must be written back
+
+*/
+
+//----------------------------------------------------------------------
+
+bool
+
+FileHeader::IsDirty()
+
+{
+
+  return dirty;
+
 }
 
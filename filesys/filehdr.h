@@ -265,10 +265,16 @@ class FileHeader {
 
   void SetDir();                   //!< Mark this header as a directory header
 
+  bool IsDirty();                  //!< return true if the header was modified
+
+                                   //!< since it was read or written back
+
   private:
 
   int isdir;
 
+  bool dirty;                           //!< true if the header differs from disk
+
   int numBytes;			        //!< Number of bytes in the file
 
   int numSectors;			//!< Number of data sectors in the file
@@ -112,6 +112,10 @@
 
 #include "filesys/oftable.h"
 
+#include "filesys/bufcache.h"
+
+#include "filesys/namecache.h"
+
 
 
 /*! Sectors containing the file headers for the bitmap of free sectors,
@@ -182,19 +186,21 @@ bool decompname (const char * orig_path, char * head, char * tail)
 
   
 
-  // Init "tail" with the remainder
+  // Init "tail" with the remainder (memmove, since tail may overlap
+
+  // orig_path)
 
   if(*path == '\0') {
 
     *head = '\0';
 
-    strcpy(tail, orig_path);
+    memmove(tail, orig_path, strlen(orig_path) + 1);
 
     return false;
 
   } else {
 
-    strcpy(tail, path);
+    memmove(tail, path, strlen(path) + 1);
 
     return true;
 
@@ -204,6 +210,86 @@ bool decompname (const char * orig_path, char * head, char * tail)
 
 
 
+//----------------------------------------------------------------------
+
+// LookupName
+
+/*!
+
+//  this function returns the disc sector of the fileheader of a name
+
+//  of a directory. It is found in the name cache if possible, else the
+
+//  directory and the fileheader are read and the result is cached.
+
+//
+
+//   \param dirSector is the disc sector of the fileheader of the
+
+//     directory
+
+//   \param name is the name to look up (NOT MODIFIED)
+
+//   \param isDir is set to true if name is a directory
+
+//   
+
+eturn the sector number of the fileheader, or -1 if the name
+
+//     does not exist
+
+*/
+
+//----------------------------------------------------------------------
+
+int LookupName(int dirSector, char *name, bool *isDir)
+
+{
+
+  int sector;
+
+
+
+  if (g_name_cache->Lookup(dirSector, name, &sector, isDir))
+
+    return sector;
+
+
+
+  // Read the directory, noting the invalidations that may occur
+
+  // meanwhile
+
+  int generation = g_name_cache->Generation();
+
+  OpenFile dirfile(dirSector);
+
+  Directory directory(g_cfg->NumDirEntries);
+
+  directory.FetchFrom(&dirfile);
+
+
+
+  *isDir = false;
+
+  sector = directory.Find(name);
+
+  if (sector >= 0) {
+
+    OpenFile file(sector);
+
+    *isDir = file.IsDir();
+
+  }
+
+  g_name_cache->Enter(dirSector, name, sector, *isDir, generation);
+
+  return sector;
+
+}
+
+
+
 //----------------------------------------------------------------------
 
 // FindDir
@@ -252,14 +338,6 @@ int FindDir(char *name)
 
 
 
-  // Fetch the root directory from disk
-
-  Directory directory(g_cfg->NumDirEntries);
-
-  directory.FetchFrom(g_file_system->GetDirFile());
-
-
-
   // Start the search in the root directory
 
   int sector = DirectorySector;
@@ -272,7 +350,9 @@ int FindDir(char *name)
 
     // Get the sector of the file/directory corresponding to 'name'
 
-    sector = directory.Find(dirname);
+    bool isDir;
+
+    sector = LookupName(sector, dirname, &isDir);
 
     if (sector < 0)
 
@@ -282,13 +362,7 @@ int FindDir(char *name)
 
     // Check that it is a directory
 
-    OpenFile file(sector);
-
-    if(file.GetFileHeader()->IsDir())
-
-      directory.FetchFrom(&file);
-
-    else
+    if (!isDir)
 
       return -1;
 
@@ -304,6 +378,50 @@ int FindDir(char *name)
 
 
 
+//----------------------------------------------------------------------
+
+// PinFile
+
+/*! 	Keep the header and the contents of a file in the buffer cache,
+
+//	as long as the cache lets us pin them.
+
+//
+
+//	\param hdrSector sector of the file header
+
+//	\param file the file, opened
+
+*/
+
+//----------------------------------------------------------------------
+
+
+
+static void
+
+PinFile(int hdrSector, OpenFile *file)
+
+{
+
+    FileHeader *hdr = file->GetFileHeader();
+
+
+
+    if (!g_buffer_cache->Pin(hdrSector))
+
+      return;
+
+    for (int pos = 0; pos < hdr->FileLength(); pos += g_cfg->SectorSize)
+
+      if (!g_buffer_cache->Pin(hdr->ByteToSector(pos)))
+
+	return;
+
+}
+
+
+
 //----------------------------------------------------------------------
 
 // FileSystem::FileSystem
@@ -450,6 +568,16 @@ FileSystem::FileSystem(bool format)
 
     }
 
+
+
+    // The free map and the root directory are read by most of the
+
+    // file system operations: keep them in the buffer cache
+
+    PinFile(FreeMapSector, freeMapFile);
+
+    PinFile(DirectorySector, directoryFile);
+
 }
 
 
@@ -650,6 +778,8 @@ FileSystem::Create(char *name, int initialSize)
 
     freeMap.WriteBack(freeMapFile);     // Freemap
 
+    g_name_cache->Invalidate(dirsector, dirname);
+
 
 
     DEBUG('f', (char*)"END Creating file %s, size %d\n", name, initialSize);
@@ -706,23 +836,15 @@ FileSystem::Open(char *name)
 
 
 
-  // Read the directory from disk
-
-  OpenFile dirfile(dirsector);
+  // Find the file in the directory
 
   DEBUG('f', (char*)"Opening file %s\n", name);
 
-  Directory directory(g_cfg->NumDirEntries);
+  bool isDir;
 
-  directory.FetchFrom(&dirfile);
-
-
-
-  // Find the file in the directory
-
-  sector = directory.Find(dirname); 
+  sector = LookupName(dirsector, dirname, &isDir);
 
-  if (sector >= 0)
+  if ((sector >= 0) && !isDir)
 
     { 		
 
@@ -730,16 +852,6 @@ FileSystem::Open(char *name)
 
     openFile->SetName(name);
 
-    if (openFile->IsDir())
-
-      {
-
-	delete openFile;
-
-	return NULL;
-
-      }
-
     }
 
 
@@ -876,6 +988,8 @@ FileSystem::Remove(char *name)
 
   directory.WriteBack(&dirfile);        // directory
 
+  g_name_cache->Invalidate(dirsector, dirname);
+
 
 
   return NO_ERROR;
@@ -1184,6 +1298,8 @@ FileSystem::Mkdir(char *dirname)
 
   freeMap.WriteBack(freeMapFile);
 
+  g_name_cache->Invalidate(parentsect, name);
+
 
 
   return NO_ERROR;  
@@ -1336,6 +1452,10 @@ FileSystem::Rmdir(char *dirname)
 
   parentdir.WriteBack(&parentdirfile);    // parent directory
 
+  g_name_cache->Invalidate(parentsect, name);
+
+  g_name_cache->Purge(thedirsect);
+
 
 
   return NO_ERROR;
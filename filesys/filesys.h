@@ -76,6 +76,8 @@
 
 int FindDir(char *);
 
+int LookupName(int dirSector, char *name, bool *isDir);
+
 /*! \brief Defines the Nachos file system
 
  */
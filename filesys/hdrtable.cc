@@ -0,0 +1,262 @@
+/*! \file hdrtable.cc
+
+// \brief Routines of the in-core file header table
+
+//
+
+// The headers are hashed by their sector in NBHDRBUCKETS chained
+
+// buckets. The table lock is held across the disk transfers, so that
+
+// a thread opening a file never sees a header still being fetched.
+
+//
+
+//  Copyright (c) 1999-2000 INSA de Rennes.
+
+//  All rights reserved.
+
+//  See copyright_insa.h for copyright notice and limitation
+
+//  of liability and disclaimer of warranty provisions.
+
+*/
+
+
+
+#include "kernel/system.h"
+
+#include "utility/stats.h"
+
+#include "filesys/hdrtable.h"
+
+
+
+//----------------------------------------------------------
+
+// HeaderTable::HeaderTable
+
+//! Initialize an empty header table
+
+//----------------------------------------------------------
+
+HeaderTable::HeaderTable()
+
+{
+
+  for (int i = 0; i < NBHDRBUCKETS; i++)
+
+    buckets[i] = NULL;
+
+  lock = new Lock((char *)"header table");
+
+}
+
+
+
+//----------------------------------------------------------
+
+// HeaderTable::~HeaderTable
+
+//! Free the headers left in the table
+
+//----------------------------------------------------------
+
+HeaderTable::~HeaderTable()
+
+{
+
+  for (int i = 0; i < NBHDRBUCKETS; i++)
+
+    while (buckets[i] != NULL) {
+
+      struct hdrentry_c *entry = buckets[i];
+
+      buckets[i] = entry->next;
+
+      delete entry->hdr;
+
+      delete entry;
+
+    }
+
+  delete lock;
+
+}
+
+
+
+//----------------------------------------------------------
+
+// HeaderTable::Get
+
+/*! Find the header located at a sector in the table, or fetch it
+
+// from disk if no open file uses it yet, and take a reference on it.
+
+//
+
+// \param sector the sector of the file header
+
+// \return the shared in-core header
+
+*/
+
+//----------------------------------------------------------
+
+FileHeader *
+
+HeaderTable::Get(int sector)
+
+{
+
+  struct hdrentry_c *entry;
+
+
+
+  lock->Acquire();
+
+  for (entry = buckets[sector % NBHDRBUCKETS]; entry != NULL;
+
+       entry = entry->next)
+
+    if (entry->sector == sector)
+
+      break;
+
+
+
+  if (entry != NULL)
+
+    g_stats->incrHeaderHits();
+
+  else {
+
+    g_stats->incrHeaderFetches();
+
+    entry = new struct hdrentry_c;
+
+    entry->sector = sector;
+
+    entry->hdr = new FileHeader;
+
+    entry->hdr->FetchFrom(sector);
+
+    entry->refs = 0;
+
+    entry->next = buckets[sector % NBHDRBUCKETS];
+
+    buckets[sector % NBHDRBUCKETS] = entry;
+
+  }
+
+  entry->refs++;
+
+  lock->Release();
+
+  return entry->hdr;
+
+}
+
+
+
+//----------------------------------------------------------
+
+// HeaderTable::Put
+
+/*! Drop a reference on an in-core header. The last one writes the
+
+// header back if it was modified, and frees it.
+
+//
+
+// \param sector the sector of the file header
+
+*/
+
+//----------------------------------------------------------
+
+void
+
+HeaderTable::Put(int sector)
+
+{
+
+  struct hdrentry_c **link;
+
+
+
+  lock->Acquire();
+
+  for (link = &buckets[sector % NBHDRBUCKETS]; *link != NULL;
+
+       link = &(*link)->next)
+
+    if ((*link)->sector == sector)
+
+      break;
+
+  ASSERT(*link != NULL);
+
+
+
+  struct hdrentry_c *entry = *link;
+
+  if (--entry->refs == 0) {
+
+    if (entry->hdr->IsDirty()) {
+
+      g_stats->incrHeaderWritebacks();
+
+      entry->hdr->WriteBack(sector);
+
+    }
+
+    *link = entry->next;
+
+    delete entry->hdr;
+
+    delete entry;
+
+  }
+
+  lock->Release();
+
+}
+
+
+
+//----------------------------------------------------------
+
+// HeaderTable::Flush
+
+//! Write back the modified headers of the open files
+
+//----------------------------------------------------------
+
+void
+
+HeaderTable::Flush()
+
+{
+
+  lock->Acquire();
+
+  for (int i = 0; i < NBHDRBUCKETS; i++)
+
+    for (struct hdrentry_c *entry = buckets[i]; entry != NULL;
+
+	 entry = entry->next)
+
+      if (entry->hdr->IsDirty()) {
+
+	g_stats->incrHeaderWritebacks();
+
+	entry->hdr->WriteBack(entry->sector);
+
+      }
+
+  lock->Release();
+
+}
+
@@ -0,0 +1,110 @@
+/*! \file hdrtable.h
+
+   \brief In-core table of the file headers of the open files
+
+
+
+   Every OpenFile of a file shares the same in-core FileHeader (the
+
+   "i-node"), found by the sector of the header in a hash table and
+
+   fetched from the disk by the first open only. The headers are
+
+   reference counted: the last close writes the header back, if it
+
+   was modified, and frees it.
+
+
+
+    Copyright (c) 1999-2000 INSA de Rennes.
+
+    All rights reserved.
+
+    See copyright_insa.h for copyright notice and limitation
+
+    of liability and disclaimer of warranty provisions.
+
+*/
+
+
+
+#ifndef FS_HDRTABLE
+
+#define FS_HDRTABLE
+
+
+
+#include "kernel/synch.h"
+
+#include "filesys/filehdr.h"
+
+
+
+//! Number of buckets of the hash table of the in-core headers
+
+#define NBHDRBUCKETS 31
+
+
+
+/*! \brief Defines the table of the in-core file headers
+
+*/
+
+class HeaderTable {
+
+public:
+
+  HeaderTable();               // initialize an empty table
+
+  ~HeaderTable();              // the headers must all have been released
+
+
+
+  FileHeader *Get(int sector); /*!< return the header located at sector,
+
+				    fetching it from disk if it is not
+
+				    in core, and take a reference on it
+
+			       */
+
+  void Put(int sector);        /*!< drop a reference on the header at
+
+				    sector, and write it back and free
+
+				    it with the last one
+
+			       */
+
+  void Flush();                //!< write back the modified headers
+
+
+
+private:
+
+  //! An in-core header
+
+  struct hdrentry_c {
+
+    int sector;                //!< Sector of the header on disk
+
+    FileHeader *hdr;           //!< The header
+
+    int refs;                  //!< Number of OpenFile using it
+
+    struct hdrentry_c *next;   //!< Next header of the same bucket
+
+  };
+
+
+
+  struct hdrentry_c *buckets[NBHDRBUCKETS]; //!< hash table of the headers
+
+  Lock *lock;                  //!< Serializes the fetches and write backs
+
+};
+
+
+
+#endif // FS_HDRTABLE
+
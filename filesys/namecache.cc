@@ -0,0 +1,418 @@
+/*! \file namecache.cc
+
+// \brief Routines of the cache of the directory entries
+
+//
+
+// The names are compared on their FILENAMEMAXLEN first characters,
+
+// like in the directories. The operations never sleep, so they need
+
+// no lock.
+
+//
+
+//  Copyright (c) 1999-2000 INSA de Rennes.
+
+//  All rights reserved.
+
+//  See copyright_insa.h for copyright notice and limitation
+
+//  of liability and disclaimer of warranty provisions.
+
+*/
+
+
+
+#include <string.h>
+
+#include "kernel/system.h"
+
+#include "utility/stats.h"
+
+#include "filesys/namecache.h"
+
+
+
+//----------------------------------------------------------
+
+// NameCache::NameCache
+
+/*! Create an empty name cache
+
+//
+
+// \param size number of entries of the cache (0 disables it)
+
+*/
+
+//----------------------------------------------------------
+
+NameCache::NameCache(int size)
+
+{
+
+  numEntries = size;
+
+  dirOf = new int[numEntries];
+
+  nameOf = new char*[numEntries];
+
+  sectorOf = new int[numEntries];
+
+  isDirOf = new bool[numEntries];
+
+  nextOf = new int[numEntries];
+
+  for (int i = 0; i < numEntries; i++) {
+
+    dirOf[i] = -1;
+
+    nameOf[i] = new char[FILENAMEMAXLEN + 1];
+
+  }
+
+  for (int b = 0; b < NBNAMEBUCKETS; b++)
+
+    buckets[b] = -1;
+
+  victim = 0;
+
+  generation = 0;
+
+}
+
+
+
+//----------------------------------------------------------
+
+// NameCache::~NameCache
+
+//! Delete the name cache
+
+//----------------------------------------------------------
+
+NameCache::~NameCache()
+
+{
+
+  for (int i = 0; i < numEntries; i++)
+
+    delete [] nameOf[i];
+
+  delete [] dirOf;
+
+  delete [] nameOf;
+
+  delete [] sectorOf;
+
+  delete [] isDirOf;
+
+  delete [] nextOf;
+
+}
+
+
+
+//----------------------------------------------------------
+
+// NameCache::Lookup
+
+/*! Look a name of a directory up in the cache
+
+//
+
+// \param dirSector sector of the header of the directory
+
+// \param name the name to look up
+
+// \param sector set to the sector of the file header, -1 if the
+
+//        name is known to be missing from the directory
+
+// \param isDir set to true if the name is a directory
+
+// \return true if the name is cached
+
+*/
+
+//----------------------------------------------------------
+
+bool
+
+NameCache::Lookup(int dirSector, char *name, int *sector, bool *isDir)
+
+{
+
+  int entry = FindEntry(dirSector, name);
+
+
+
+  if (entry < 0) {
+
+    g_stats->incrNameMisses();
+
+    return false;
+
+  }
+
+  g_stats->incrNameHits(sectorOf[entry] < 0);
+
+  *sector = sectorOf[entry];
+
+  *isDir = isDirOf[entry];
+
+  return true;
+
+}
+
+
+
+//----------------------------------------------------------
+
+// NameCache::Enter
+
+/*! Cache the result of the lookup of a name in a directory, read
+
+// from the disk. It is dropped if an entry was invalidated since
+
+// the directory was read, as it may be out of date.
+
+//
+
+// \param dirSector sector of the header of the directory
+
+// \param name the name looked up
+
+// \param sector sector of the file header, -1 if the name is missing
+
+// \param isDir true if the name is a directory
+
+// \param generationRead value of Generation() before reading the
+
+//        directory
+
+*/
+
+//----------------------------------------------------------
+
+void
+
+NameCache::Enter(int dirSector, char *name, int sector, bool isDir,
+
+		 int generationRead)
+
+{
+
+  if ((numEntries == 0) || (generationRead != generation))
+
+    return;
+
+
+
+  int entry = FindEntry(dirSector, name);
+
+  if (entry < 0) {
+
+    // Replace the oldest entry
+
+    entry = victim;
+
+    victim = (victim + 1) % numEntries;
+
+    if (dirOf[entry] >= 0)
+
+      Unlink(entry);
+
+    dirOf[entry] = dirSector;
+
+    strncpy(nameOf[entry], name, FILENAMEMAXLEN);
+
+    nameOf[entry][FILENAMEMAXLEN] = '\0';
+
+    int b = Hash(dirSector, name);
+
+    nextOf[entry] = buckets[b];
+
+    buckets[b] = entry;
+
+  }
+
+  sectorOf[entry] = sector;
+
+  isDirOf[entry] = isDir;
+
+}
+
+
+
+//----------------------------------------------------------
+
+// NameCache::Invalidate
+
+/*! Drop the entry of a name added to or removed from a directory
+
+//
+
+// \param dirSector sector of the header of the directory
+
+// \param name the name added or removed
+
+*/
+
+//----------------------------------------------------------
+
+void
+
+NameCache::Invalidate(int dirSector, char *name)
+
+{
+
+  generation++;
+
+  int entry = FindEntry(dirSector, name);
+
+  if (entry >= 0) {
+
+    Unlink(entry);
+
+    dirOf[entry] = -1;
+
+  }
+
+}
+
+
+
+//----------------------------------------------------------
+
+// NameCache::Purge
+
+/*! Drop the entries of a deleted directory, whose header sector may
+
+// be reused
+
+//
+
+// \param dirSector sector of the header of the directory
+
+*/
+
+//----------------------------------------------------------
+
+void
+
+NameCache::Purge(int dirSector)
+
+{
+
+  generation++;
+
+  for (int i = 0; i < numEntries; i++)
+
+    if (dirOf[i] == dirSector) {
+
+      Unlink(i);
+
+      dirOf[i] = -1;
+
+    }
+
+}
+
+
+
+//----------------------------------------------------------
+
+// NameCache::Hash
+
+/*! \return the bucket of a name of a directory
+
+*/
+
+//----------------------------------------------------------
+
+int
+
+NameCache::Hash(int dirSector, char *name)
+
+{
+
+  unsigned int h = dirSector;
+
+
+
+  for (int i = 0; (i < FILENAMEMAXLEN) && (name[i] != '\0'); i++)
+
+    h = h * 31 + (unsigned char)name[i];
+
+  return h % NBNAMEBUCKETS;
+
+}
+
+
+
+//----------------------------------------------------------
+
+// NameCache::FindEntry
+
+/*! \return the entry of a name of a directory, or -1 if it is not
+
+// cached
+
+*/
+
+//----------------------------------------------------------
+
+int
+
+NameCache::FindEntry(int dirSector, char *name)
+
+{
+
+  if (numEntries == 0)
+
+    return -1;
+
+  for (int entry = buckets[Hash(dirSector, name)]; entry >= 0;
+
+       entry = nextOf[entry])
+
+    if ((dirOf[entry] == dirSector)
+
+	&& (strncmp(nameOf[entry], name, FILENAMEMAXLEN) == 0))
+
+      return entry;
+
+  return -1;
+
+}
+
+
+
+//----------------------------------------------------------
+
+// NameCache::Unlink
+
+//! Remove an entry from its bucket
+
+//----------------------------------------------------------
+
+void
+
+NameCache::Unlink(int entry)
+
+{
+
+  int *link = &buckets[Hash(dirOf[entry], nameOf[entry])];
+
+
+
+  while (*link != entry)
+
+    link = &nextOf[*link];
+
+  *link = nextOf[entry];
+
+}
+
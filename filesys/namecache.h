@@ -0,0 +1,148 @@
+/*! \file namecache.h
+
+   \brief Cache of the directory entries used to resolve path names
+
+
+
+   The cache maps a name in a directory (the sector of the directory
+
+   header and the name) to the sector of the file header it names,
+
+   and remembers whether it is a directory. Names missing from a
+
+   directory are cached as well (negative entries, with sector -1), so
+
+   that looking up a path on a warm cache reads no directory and no
+
+   file header at all.
+
+
+
+   The file system operations that modify a directory invalidate the
+
+   entries they change. A lookup that missed and read the directory
+
+   only enters its result if no entry was invalidated in the meantime
+
+   (the lookup may have slept on the disk).
+
+
+
+   The cache holds NameCacheSize entries, replaced in FIFO order.
+
+
+
+    Copyright (c) 1999-2000 INSA de Rennes.
+
+    All rights reserved.
+
+    See copyright_insa.h for copyright notice and limitation
+
+    of liability and disclaimer of warranty provisions.
+
+*/
+
+
+
+#ifndef FS_NAMECACHE
+
+#define FS_NAMECACHE
+
+
+
+#include "filesys/directory.h"
+
+
+
+//! Number of buckets of the hash table of the name cache
+
+#define NBNAMEBUCKETS 31
+
+
+
+/*! \brief Defines the cache of the directory entries
+
+*/
+
+class NameCache {
+
+public:
+
+  NameCache(int size);         // create an empty cache of size entries
+
+  ~NameCache();
+
+
+
+  bool Lookup(int dirSector, char *name, int *sector, bool *isDir);
+
+                               /*!< find the sector of name in a
+
+				    directory (-1 if it does not exist),
+
+				    return false if it is not cached
+
+			       */
+
+  int Generation() { return generation; }
+
+                               /*!< to be read before reading the
+
+				    directory of a lookup that missed
+
+			       */
+
+  void Enter(int dirSector, char *name, int sector, bool isDir,
+
+	     int generationRead);
+
+                               /*!< cache the result of a lookup, unless
+
+				    an entry was invalidated since
+
+				    generationRead
+
+			       */
+
+  void Invalidate(int dirSector, char *name);
+
+                               //!< the directory entry name is modified
+
+  void Purge(int dirSector);   //!< the directory is deleted
+
+
+
+private:
+
+  int Hash(int dirSector, char *name);  //!< Bucket of a name
+
+  int FindEntry(int dirSector, char *name); //!< Entry of a name, or -1
+
+  void Unlink(int entry);               //!< Remove an entry from its bucket
+
+
+
+  int numEntries;              //!< Number of entries of the cache
+
+  int *dirOf;                  //!< Directory of each entry, -1 if free
+
+  char **nameOf;               //!< Name of each entry
+
+  int *sectorOf;               //!< Sector named by each entry, -1 if none
+
+  bool *isDirOf;               //!< true if the entry names a directory
+
+  int *nextOf;                 //!< Next entry of the same bucket
+
+  int buckets[NBNAMEBUCKETS];  //!< First entry of each bucket, or -1
+
+  int victim;                  //!< Next entry to replace
+
+  int generation;              //!< Number of invalidations
+
+};
+
+
+
+#endif // FS_NAMECACHE
+
@@ -38,6 +38,8 @@
 
 #include "filesys/oftable.h"
 
+#include "filesys/namecache.h"
+
 
 
 //----------------------------------------------------------
@@ -242,7 +244,7 @@ OpenFile * OpenFileTable::Open(char *name)
 
        OpenFile *openfile = NULL;
 
-       Directory directory(g_cfg->NumDirEntries);
+       bool isDir;
 
 
 
@@ -252,45 +254,21 @@ OpenFile * OpenFileTable::Open(char *name)
 
 
 
-       // Find the directory containing the file and read it from the disk
+       // Find the directory containing the file
 
        dirsector = FindDir(filename);
 
        if (dirsector == -1) return NULL;
 
-       OpenFile dirfile(dirsector);
-
-       directory.FetchFrom(&dirfile);
-
 
 
        // Find the file in the directory
 
-       sector=directory.Find(filename);
-
-       if (sector >= 0)
-
-	 { 		
-
-	   openfile = new OpenFile(sector);	// name was found in directory 
-
-	   if (openfile->IsDir())               // name is a directory ...
-
-	     {
+       sector=LookupName(dirsector, filename, &isDir);
 
-	       delete openfile;
+       if ((sector < 0) || isDir)              // name isn't in directory
 
-	       delete entry;
-
-	       return NULL;
-
-	     }
-
-	 }
-
-       else                                    // name isn't in directory
-
-	 {
+	 {                                     // or is a directory ...
 
 	   delete entry;
 
@@ -298,6 +276,8 @@ OpenFile * OpenFileTable::Open(char *name)
 
 	 }
 
+       openfile = new OpenFile(sector);	       // name was found in directory 
+
 
 
        // We found the file
@@ -582,6 +562,8 @@ int OpenFileTable::Remove(char *name)
 
       directory.WriteBack(&dirfile);
 
+      g_name_cache->Invalidate(dirsector, filename);
+
     }
 
   else                  // file isn't opened
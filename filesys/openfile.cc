@@ -16,7 +16,9 @@
 
 //	Also as in UNIX, for convenience, we keep the file header in
 
-//	memory while the file is open.
+//	memory while the file is open. It is shared by all the opens of
+
+//	the file, through the in-core header table.
 
 */
 
@@ -40,7 +42,9 @@
 
 #include "filesys/openfile.h"
 
-#include "drivers/drvDisk.h"
+#include "filesys/bufcache.h"
+
+#include "filesys/hdrtable.h"
 
 
 
@@ -52,7 +56,9 @@
 
 /*! 	Open a Nachos file for reading and writing.  Bring the file header
 
-//	into memory while the file is open.
+//	into memory while the file is open, unless another open of the
+
+//	file did already.
 
 //
 
@@ -66,19 +72,15 @@ OpenFile::OpenFile(int sector)
 
 {
 
-  // Allocate the file header and file name
-
-  hdr = new FileHeader;
+  // Allocate the file name
 
   name = new char[g_cfg->MaxFileNameSize];
 
-  ASSERT(hdr != 0);
 
 
+  // Get the file header shared by the opens of the file
 
-  // Fetch the file header from disk
-
-  hdr->FetchFrom(sector);
+  hdr = g_header_table->Get(sector);
 
 
 
@@ -98,7 +100,13 @@ OpenFile::OpenFile(int sector)
 
 // OpenFile::~OpenFile
 
-//! 	Close a Nachos file, de-allocating any in-memory data structures.
+/*! 	Close a Nachos file, de-allocating any in-memory data structures.
+
+//	The last close of the file writes its header back if it was
+
+//	modified.
+
+*/
 
 //----------------------------------------------------------------------
 
@@ -108,7 +116,7 @@ OpenFile::~OpenFile()
 
   type = INVALID_TYPE;
 
-  delete hdr;
+  g_header_table->Put(fSector);
 
   delete [] name;
 
@@ -274,7 +282,7 @@ OpenFile::ReadAt(char *into, int numBytes, int position)
 
     int fileLength = hdr->FileLength();
 
-    int i, firstSector, lastSector, numSectors;
+    int firstSector, lastSector, numSectors;
 
 
 
@@ -310,11 +318,7 @@ OpenFile::ReadAt(char *into, int numBytes, int position)
 
     char buf [numSectors * g_cfg->SectorSize];
 
-    for (i = firstSector; i <= lastSector; i++)	
-
-        g_disk_driver->ReadSector(hdr->ByteToSector(i * g_cfg->SectorSize), 
-
-					&buf[(i - firstSector) * g_cfg->SectorSize]);
+    TransferSectors(buf, firstSector, numSectors, false);
 
 
 
@@ -382,7 +386,7 @@ OpenFile::WriteAt(char *from, int numBytes, int position)
 
     int maxFileLength = hdr->MaxFileLength();
 
-    int i, firstSector, lastSector, numSectors;
+    int firstSector, lastSector, numSectors;
 
     bool firstAligned, lastAligned;
 
@@ -484,13 +488,75 @@ OpenFile::WriteAt(char *from, int numBytes, int position)
 
     // write modified sectors back
 
-    for (i = firstSector; i <= lastSector; i++)	
+    TransferSectors(buf, firstSector, numSectors, true);
 
-      g_disk_driver->WriteSector(hdr->ByteToSector(i * g_cfg->SectorSize), 
+    return numBytes;
 
-			     &buf[(i - firstSector) * g_cfg->SectorSize]);
+}
 
-    return numBytes;
+
+
+//----------------------------------------------------------------------
+
+// OpenFile::TransferSectors
+
+/*!
+
+// 	Read or write whole sectors of the file, through the buffer
+
+//	cache. The sectors contiguous on the disk are transferred
+
+//	together, so that the sectors missing from the cache are read
+
+//	by a single disk request.
+
+//
+
+//	\param buf the buffer of the sectors contents
+
+//	\param firstSector the first sector to transfer, within the file
+
+//	\param numSectors the number of sectors to transfer
+
+//	\param writing true to write the sectors, false to read them
+
+*/
+
+//----------------------------------------------------------------------
+
+void
+
+OpenFile::TransferSectors(char *buf, int firstSector, int numSectors,
+
+			  bool writing)
+
+{
+
+    int i, run;
+
+
+
+    for (i = 0; i < numSectors; i += run) {
+
+      int sector = hdr->ByteToSector((firstSector + i) * g_cfg->SectorSize);
+
+      for (run = 1; i + run < numSectors; run++)
+
+	if (hdr->ByteToSector((firstSector + i + run) * g_cfg->SectorSize)
+
+	    != sector + run)
+
+	  break;
+
+      if (writing)
+
+	g_buffer_cache->WriteSectors(sector, &buf[i * g_cfg->SectorSize], run);
+
+      else
+
+	g_buffer_cache->ReadSectors(sector, &buf[i * g_cfg->SectorSize], run);
+
+    }
 
 }
 
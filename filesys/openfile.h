@@ -138,16 +138,28 @@ public:
 
   bool IsDir();                       //!< return true if the file is a directory
 
+  
+
+  int GetSector() { return fSector; } //!< return the sector of the file header
+
 private:
 
   char* name;                         //!< the file's name.
 
-  FileHeader *hdr;		      //!< Header for this file 
+  FileHeader *hdr;		      //!< Header for this file, shared by its opens
 
   int seekPosition;		      //!< Current position within the file
 
   int fSector;                        //!< The file's first sector
 
+
+
+  //! Read/write whole sectors of the file, by runs of contiguous disk sectors
+
+  void TransferSectors(char *buf, int firstSector, int numSectors,
+
+		       bool writing);
+
   
 
 public:
@@ -54,6 +54,8 @@
 
 #include "filesys/openfile.h"
 
+#include "filesys/oftable.h"
+
 #include "vm/physMem.h"
 
 #include "kernel/elf32.h"
@@ -140,6 +142,12 @@ AddrSpace::AddrSpace(OpenFile * exec_file, Process *p, int *err)
 
   process = p;
 
+  residentPages = 0;
+
+  nextFaultPage = -1;
+
+  prefetchWindow = g_cfg->FaultAround;
+
 
 
   /* Empty user address space requested ? */
@@ -320,6 +328,7 @@ AddrSpace::AddrSpace(OpenFile * exec_file, Process *p, int *err)
 
       // in memory (demand paging will be implemented later on)
 
+    #ifndef ETUDIANTS_TP
       for (unsigned int pgdisk = 0,
 
 	     virt_page = section_table[i].sh_addr / g_cfg->PageSize ;
@@ -330,8 +339,6 @@ AddrSpace::AddrSpace(OpenFile * exec_file, Process *p, int *err)
 
 	{
 
-    #ifndef ETUDIANTS_TP
-
 	  /* Without demand paging */
 
 	  
@@ -427,39 +434,34 @@ AddrSpace::AddrSpace(OpenFile * exec_file, Process *p, int *err)
 	  
 
 	  /* End of code without demand paging */
+
+	}
     #endif
     #ifdef ETUDIANTS_TP
-     // Set up default values for the page table entry
+      // Pages are loaded on demand: only set up the page table entries,
+      // for all the pages of the section at once
+      int first_page = section_table[i].sh_addr / g_cfg->PageSize;
 
-	  translationTable->clearBitSwap(virt_page);
+      int num_pages = divRoundUp(section_table[i].sh_size, g_cfg->PageSize);
 
-	  translationTable->setBitReadAllowed(virt_page);
+      translationTable->setRangeAccess(first_page, num_pages, true,
+				       (section_table[i].sh_flags & SHF_WRITE) != 0);
 
-	  if (section_table[i].sh_flags & SHF_WRITE) {
-	    translationTable->setBitWriteAllowed(virt_page);
-    } else {
-      translationTable->clearBitWriteAllowed(virt_page);
-    } 
-
-	  
+      if (section_table[i].sh_type != SHT_NOBITS) {
 
-    if (section_table[i].sh_type != SHT_NOBITS) {
+	// Pages read from the executable file, page after page
+	translationTable->setRangeAddrDisk(first_page, num_pages,
+					   section_table[i].sh_offset,
+					   g_cfg->PageSize);
 
-	    translationTable->setAddrDisk(virt_page,section_table[i].sh_offset + pgdisk*g_cfg->PageSize);
-
-	  } else {
-
-	    translationTable->setAddrDisk(virt_page,-1);
-
-	  }
+      } else {
 
-    translationTable->clearBitIo(virt_page);
+	// Anonymous pages (bss section)
+	translationTable->setRangeAddrDisk(first_page, num_pages, -1, 0);
 
-    translationTable->clearBitValid(virt_page);
+      }
     #endif
 
-	}
-
     }
 
   delete [] shnames;
@@ -484,6 +486,164 @@ AddrSpace::AddrSpace(OpenFile * exec_file, Process *p, int *err)
 
 
 
+//----------------------------------------------------------------------
+
+/**	Create a copy of the address space of a process (Fork).
+
+ //
+
+ //      The pages are not copied: the pages in memory are mapped in
+
+ //      both address spaces, and the pages in the swap area share
+
+ //      their sector. Writable pages become read-only in both
+
+ //      address spaces, and are copied by the page fault manager on
+
+ //      the first write to them (copy-on-write).
+
+ //
+
+ //	\param parent is the address space to copy
+
+ //   \param p: process using the new address space
+
+ //   \param err: error code 0 if OK, -1 otherwise
+
+ */
+
+//----------------------------------------------------------------------
+
+AddrSpace::AddrSpace(AddrSpace *parent, Process *p, int *err)
+
+{
+
+  TranslationTable *parentTable = parent->translationTable;
+
+  *err = 0;
+
+  process = p;
+
+  residentPages = 0;
+
+  nextFaultPage = -1;
+
+  prefetchWindow = g_cfg->FaultAround;
+
+  freePageId = parent->freePageId;
+
+  CodeStartAddress = parent->CodeStartAddress;
+
+  nb_mapped_files = 0;
+
+  translationTable = new TranslationTable();
+
+
+
+  for (int i = 0 ; i < freePageId ; i++) {
+
+
+
+    if (!parentTable->getBitReadAllowed(i) && !parentTable->getBitWriteAllowed(i)
+
+	&& !parentTable->getBitCow(i))
+
+      continue;
+
+
+
+    // Wait for the end of the transfers in progress on the page
+
+    while (parentTable->getBitIo(i))
+
+      g_physical_mem_manager->WaitPageIo(parent, i);
+
+
+
+    if (parentTable->getBitReadAllowed(i))
+
+      translationTable->setBitReadAllowed(i);
+
+
+
+    // Writable pages are now shared copy-on-write
+
+    if (parentTable->getBitWriteAllowed(i) || parentTable->getBitCow(i)) {
+
+      parentTable->clearBitWriteAllowed(i);
+
+      parentTable->setBitCow(i);
+
+      translationTable->setBitCow(i);
+
+    }
+
+
+
+    // The page is in the executable file or in the swap area
+
+    translationTable->setAddrDisk(i, parentTable->getAddrDisk(i));
+
+    if (parentTable->getBitSwap(i)) {
+
+      translationTable->setBitSwap(i);
+
+      if (parentTable->getAddrDisk(i) >= 0)
+
+	g_swap_manager->SharePageSwap(parentTable->getAddrDisk(i));
+
+    }
+
+
+
+    // The page is in memory: map it in both address spaces
+
+    if (parentTable->getBitValid(i)) {
+
+      g_physical_mem_manager->AddSharer(parentTable->getPhysicalPage(i), this, i);
+
+      translationTable->setPhysicalPage(i, parentTable->getPhysicalPage(i));
+
+      if (parentTable->getBitM(i))
+
+	translationTable->setBitM(i);
+
+      translationTable->setBitValid(i);
+
+    }
+
+  }
+
+
+
+  // The memory-mapped files stay mapped, each address space having its
+
+  // own open file
+
+  for (int i = 0 ; i < parent->nb_mapped_files ; i++) {
+
+    OpenFile *file = g_open_file_table->Open(parent->mapped_files[i].file->GetName());
+
+    if (file == NULL) {
+
+      *err = OPENFILE_ERROR;
+
+      break;
+
+    }
+
+    mapped_files[nb_mapped_files] = parent->mapped_files[i];
+
+    mapped_files[nb_mapped_files].file = file;
+
+    nb_mapped_files++;
+
+  }
+
+}
+
+
+
 //----------------------------------------------------------------------
 
 /**   Deallocates an address space and in particular frees
@@ -502,6 +662,20 @@ AddrSpace::~AddrSpace()
 
 
 
+  // The files still mapped are closed without writing back their pages
+
+  // (see UnmapAllFiles)
+
+  for (i = 0; i < nb_mapped_files; i++) {
+
+    g_open_file_table->Close(mapped_files[i].file->GetName());
+
+    delete mapped_files[i].file;
+
+  }
+
+
+
   if (translationTable != NULL) {
 
     
@@ -516,7 +690,15 @@ AddrSpace::~AddrSpace()
 
       if (translationTable->getBitValid(i))
 
-	g_physical_mem_manager->RemovePhysicalToVirtualMapping(translationTable->getPhysicalPage(i));
+	g_physical_mem_manager->RemovePhysicalToVirtualMapping(translationTable->getPhysicalPage(i), this, i);
+
+      // If it is being written to the swap by another process, the
+
+      // page is not mapped here anymore at the end of the transfer
+
+      else if (translationTable->getBitIo(i))
+
+	g_physical_mem_manager->AbandonPage(translationTable->getPhysicalPage(i), this, i);
 
       // If it is in the swap disk, free the corresponding disk sector
 
@@ -610,8 +792,8 @@ int AddrSpace::StackAllocate(void)
 
 
 
-  for (int i = stackBasePage ; i < (stackBasePage + numPages) ; i++) {
     #ifndef ETUDIANTS_TP
+  for (int i = stackBasePage ; i < (stackBasePage + numPages) ; i++) {
     /* Without demand paging */
 
 
@@ -657,23 +839,16 @@ int AddrSpace::StackAllocate(void)
     translationTable->clearBitIo(i);
 
     /* End of code without demand paging */
+
+    }
     #endif
     #ifdef ETUDIANTS_TP
-    translationTable->clearBitValid(i);
-
-    translationTable->setAddrDisk(i,-1);
+  // Stack pages are anonymous, and allocated on demand
+  translationTable->setRangeAccess(stackBasePage, numPages, true, true);
 
-    translationTable->clearBitSwap(i);
-
-    translationTable->setBitReadAllowed(i);
-
-    translationTable->setBitWriteAllowed(i);
-
-    translationTable->clearBitIo(i);
+  translationTable->setRangeAddrDisk(stackBasePage, numPages, -1, 0);
     #endif
 
-    }
-
 
 
   int stackpointer = (stackBasePage+numPages)*g_cfg->PageSize - 4*sizeof(int);
@@ -750,7 +925,7 @@ int AddrSpace::Alloc(int numPages)
 
  * \param size: size to be mapped in bytes (rounded up to next page boundary)
 
- * \return the virtual address at which the file is mapped
+ * \return the virtual address at which the file is mapped, -1 on error
 
  */
 
@@ -759,11 +934,44 @@ int AddrSpace::Alloc(int numPages)
 int AddrSpace::Mmap(OpenFile *f, int size)
 
 {
-
+#ifndef ETUDIANTS_TP
   printf("**** Warning: method AddrSpace::Mmap is not implemented yet\n");
 
   exit(-1);
+#endif
+#ifdef ETUDIANTS_TP
+  int numPages = divRoundUp(size, g_cfg->PageSize);
+
+  if ((size <= 0) || (nb_mapped_files == MAX_MAPPED_FILES))
+    return -1;
+
+  // The mapping opens the file again: the process may close its own
+  // open file while the file is mapped
+  OpenFile *file = g_open_file_table->Open(f->GetName());
+  if (file == NULL)
+    return -1;
+
+  int firstPage = Alloc(numPages);
+  if (firstPage == -1) {
+    g_open_file_table->Close(file->GetName());
+    delete file;
+    return -1;
+  }
+
+  // The pages are read from the file on demand by the page fault
+  // manager, and written back to the file instead of the swap
+  translationTable->setRangeAccess(firstPage, numPages, true, true);
+  translationTable->setRangeAddrDisk(firstPage, numPages, 0, g_cfg->PageSize);
 
+  mapped_files[nb_mapped_files].first_address = firstPage * g_cfg->PageSize;
+  mapped_files[nb_mapped_files].size = size;
+  mapped_files[nb_mapped_files].file = file;
+  nb_mapped_files++;
+
+  DEBUG('a', (char*)"Mapped file %s at [0x%x,0x%x[\n", file->GetName(),
+	firstPage*g_cfg->PageSize, (firstPage+numPages)*g_cfg->PageSize);
+  return firstPage * g_cfg->PageSize;
+#endif
 }
 
 
@@ -783,12 +991,203 @@ int AddrSpace::Mmap(OpenFile *f, int size)
 //----------------------------------------------------------------------
 
 OpenFile *AddrSpace::findMappedFile(int32_t addr) {
-
+#ifndef ETUDIANTS_TP
   printf("**** Warning: method AddrSpace::findMappedFile is not implemented yet\n");
 
   exit(-1);
+#endif
+#ifdef ETUDIANTS_TP
+  for (int i = 0; i < nb_mapped_files; i++) {
+    int end = mapped_files[i].first_address
+      + divRoundUp(mapped_files[i].size, g_cfg->PageSize) * g_cfg->PageSize;
+    if ((addr >= mapped_files[i].first_address) && (addr < end))
+      return mapped_files[i].file;
+  }
+  return NULL;
+#endif
+}
+
+
+
+//----------------------------------------------------------------------
+
+/*! Unmap a memory-mapped file, after writing back its modified pages
+
+ *
+
+ * \param addr: virtual address returned by Mmap
+
+ * \return 0 on success, -1 if no file is mapped at this address
+
+ */
+
+//----------------------------------------------------------------------
+
+int AddrSpace::Munmap(int32_t addr)
+
+{
+
+  for (int i = 0; i < nb_mapped_files; i++)
+
+    if (mapped_files[i].first_address == addr) {
+
+      UnmapFile(i);
+
+      return 0;
+
+    }
+
+  return -1;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+/*! Unmap all the memory-mapped files, at the exit of the process
+
+ */
+
+//----------------------------------------------------------------------
+
+void AddrSpace::UnmapAllFiles()
+
+{
+
+  while (nb_mapped_files > 0)
+
+    UnmapFile(nb_mapped_files - 1);
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+/*! Unmap a memory-mapped file. Its modified pages in memory are
+
+ *  written back to the file, and its virtual pages are not accessible
+
+ *  anymore (the virtual space is not reused, see Alloc).
+
+ *
 
+ * \param i: index of the file in mapped_files
 
+ */
+
+//----------------------------------------------------------------------
+
+void AddrSpace::UnmapFile(int i)
+
+{
+
+  int pageSize = g_cfg->PageSize;
+
+  int firstPage = mapped_files[i].first_address / pageSize;
+
+  int numPages = divRoundUp(mapped_files[i].size, pageSize);
+
+  OpenFile *file = mapped_files[i].file;
+
+  char buffer[pageSize];
+
+
+
+  for (int vp = firstPage; vp < firstPage + numPages; vp++) {
+
+    // Write the page back until it is clean: it may be modified by
+
+    // another thread, or evicted, while the write waits for the disk
+
+    while (true) {
+
+      while (translationTable->getBitIo(vp))
+
+	g_physical_mem_manager->WaitPageIo(this, vp);
+
+      if (!translationTable->getBitValid(vp) || !translationTable->getBitM(vp))
+
+	break;
+
+      memcpy(buffer, &(g_machine->mainMemory[translationTable->getPhysicalPage(vp) * pageSize]),
+
+	     pageSize);
+
+      translationTable->clearBitM(vp);
+
+      WriteBackMappedPage(vp, buffer);
+
+    }
+
+
+
+    if (translationTable->getBitValid(vp))
+
+      g_physical_mem_manager->RemovePhysicalToVirtualMapping(translationTable->getPhysicalPage(vp), this, vp);
+
+    translationTable->clearBitCow(vp);
+
+  }
+
+  translationTable->setRangeAccess(firstPage, numPages, false, false);
+
+  translationTable->setRangeAddrDisk(firstPage, numPages, -1, 0);
+
+
+
+  g_open_file_table->Close(file->GetName());
+
+  delete file;
+
+  mapped_files[i] = mapped_files[--nb_mapped_files];
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+/*! Write a modified page of a memory-mapped file back to the file.
+
+ *  The file is not extended: the end of a mapping beyond the end of
+
+ *  the file is only memory, filled with zeroes on the first access.
+
+ *
+
+ * \param virtualPage: the virtual page, in a memory-mapped file
+
+ * \param data: the contents of the page
+
+ */
+
+//----------------------------------------------------------------------
+
+void AddrSpace::WriteBackMappedPage(int virtualPage, char *data)
+
+{
+
+  OpenFile *file = findMappedFile(virtualPage * g_cfg->PageSize);
+
+  ASSERT(file != NULL);
+
+  int offset = translationTable->getAddrDisk(virtualPage);
+
+  int size = file->Length() - offset;
+
+  if (size > g_cfg->PageSize)
+
+    size = g_cfg->PageSize;
+
+  if (size > 0) {
+
+    file->WriteAt(data, size, offset);
+
+    g_stats->incrMappedWrites();
+
+  }
 
 }
 
@@ -136,6 +136,26 @@ public:
 
   AddrSpace(OpenFile *exec_file, Process *p, int * err);
 
+
+
+  /**	Create a copy of the address space of a process (Fork). The
+
+   //	pages are shared by both address spaces, and copied on the
+
+   //	first write to them (copy-on-write, see physMem.h).
+
+   //
+
+   //	\param parent is the address space to copy
+
+   //   \param p: process using the new address space
+
+   //   \param err: error code 0 if OK, -1 otherwise
+
+   */
+
+  AddrSpace(AddrSpace *parent, Process *p, int * err);
+
  
 
   /**   Deallocates an address space and in particular frees
@@ -194,12 +214,38 @@ public:
 
    * \param size: size to be mapped (rounded up to next page boundary)
 
+   * \return the virtual address of the mapping, -1 on error
+
    */
 
   int Mmap(OpenFile *f, int size);
 
 
 
+  /*! Unmap a memory-mapped file, after writing back its modified pages
+
+   *
+
+   * \param addr: virtual address returned by Mmap
+
+   * \return 0 on success, -1 if no file is mapped at this address
+
+   */
+
+  int Munmap(int32_t addr);
+
+
+
+  /*! Unmap all the memory-mapped files, at the exit of the process.
+
+    The modified pages are written back: this may wait for the disk,
+
+    which the destructor cannot do */
+
+  void UnmapAllFiles();
+
+
+
   /*! Search if the address is in a memory-mapped file
 
    *
@@ -214,6 +260,28 @@ public:
 
 
 
+  /*! Number of physical pages currently holding pages of this address
+
+    space (resident set size) */
+
+  int getResidentPages() { return residentPages; }
+
+
+
+  /*! Virtual page following the last pages read from the executable
+
+    file: a fault on it is sequential (see PageFaultManager) */
+
+  int nextFaultPage;
+
+
+
+  /*! Number of pages currently read ahead on a page fault */
+
+  int prefetchWindow;
+
+
+
 private:
 
   //* Code start address, found in the ELF file
@@ -238,6 +306,26 @@ private:
 
 
 
+  /*! Unmap the memory-mapped file of index i in mapped_files */
+
+  void UnmapFile(int i);
+
+
+
+  /*! Write a modified page of a memory-mapped file back to the file
+
+   //
+
+   //    \param virtualPage the virtual page, in a memory-mapped file
+
+   //    \param data the contents of the page
+
+   */
+
+  void WriteBackMappedPage(int virtualPage, char *data);
+
+
+
   /** Number of the next virtual page to be allocated.
 
     Virtual addresses allocated in a very simple manner : an
@@ -264,6 +352,16 @@ private:
 
   t_mapped_files mapped_files;
 
+
+
+  /*! Resident set size, maintained by the physical memory manager
+
+    (see physMem.cc) */
+
+  int residentPages;
+
+  friend class PhysicalMemManager;
+
 };
 
 
@@ -36,8 +36,12 @@
 
 // of liability and disclaimer of warranty provisions.
 
+#include <limits.h>
+
 #include "drivers/drvACIA.h"
 #include "drivers/drvConsole.h"
+#include "filesys/bufcache.h"
+#include "filesys/hdrtable.h"
 #include "filesys/oftable.h"
 #include "kernel/msgerror.h"
 #include "kernel/synch.h"
@@ -62,19 +66,9 @@
 //----------------------------------------------------------------------
 
 static int GetLengthParam(int addr) {
-    int i = 0;
-
-    uint32_t c = -1;
-
     // Scan the string until the null character is found
 
-    while (c != 0) {
-        g_machine->mmu->ReadMem(addr++, 1, &c, false);
-
-        i++;
-    }
-
-    return i + 1;
+    return g_machine->mmu->ReadMemString(addr, NULL, INT_MAX) + 1;
 }
 
 //----------------------------------------------------------------------
@@ -98,23 +92,10 @@ static int GetLengthParam(int addr) {
 //----------------------------------------------------------------------
 
 static void GetStringParam(int addr, char *dest, int maxlen) {
-    int i = 0;
-
-    uint32_t c = -1;
-
-    while ((c != 0) && (i < maxlen)) {
-        // Read a character from the machine memory
-
-        g_machine->mmu->ReadMem(addr++, 1, &c, false);
-
-        // Put it in the kernel memory
+    // Copy the string from the machine memory to the kernel memory,
+    // a \0 being forced at the end
 
-        dest[i++] = (char)c;
-    }
-
-    // Force a \0 at the end
-
-    dest[maxlen - 1] = '\0';
+    g_machine->mmu->ReadMemString(addr, dest, maxlen);
 }
 
 //----------------------------------------------------------------------
@@ -218,9 +199,9 @@ void ExceptionHandler(ExceptionType exceptiontype, int vaddr)
 
                         cycle_to_nano(tick, g_cfg->ProcessorFrequency);
 
-                    g_machine->mmu->WriteMem(addr, sizeof(uint32_t), seconds);
+                    uint32_t time[2] = {WordToMachine(seconds), WordToMachine(nanos)};
 
-                    g_machine->mmu->WriteMem(addr + 4, sizeof(uint32_t), nanos);
+                    g_machine->mmu->WriteMemBlock(addr, (char *)time, sizeof(time));
 
                     g_syscall_error->SetMsg((char *)"", NO_ERROR);
 
@@ -311,8 +292,137 @@ void ExceptionHandler(ExceptionType exceptiontype, int vaddr)
                     g_syscall_error->SetMsg((char *)"", NO_ERROR);
 
                     g_machine->WriteIntRegister(2, tid);
-                    
+
                     break;
+
+                }
+
+                case SC_MMAP: {
+                    // The mmap system call
+
+                    // Maps an open file in the address space of the process
+
+                    DEBUG('e', (char *)"Memory: Mmap call.\n");
+
+                    int32_t fid = g_machine->ReadIntRegister(4);
+
+                    int size = g_machine->ReadIntRegister(5);
+
+                    OpenFile *file = (OpenFile *)g_object_ids->SearchObject(fid);
+
+                    if (file && file->type == FILE_TYPE) {
+                        int addr = g_current_thread->GetProcessOwner()->addrspace->Mmap(file, size);
+
+                        if (addr == -1) {
+                            g_machine->WriteIntRegister(2, ERROR);
+
+                            g_syscall_error->SetMsg(file->GetName(), OUT_OF_MEMORY);
+                        }
+
+                        else {
+                            g_machine->WriteIntRegister(2, addr);
+
+                            g_syscall_error->SetMsg((char *)"", NO_ERROR);
+                        }
+                    }
+
+                    else {
+                        g_machine->WriteIntRegister(2, ERROR);
+
+                        sprintf(msg, "%d", fid);
+
+                        g_syscall_error->SetMsg(msg, INVALID_FILE_ID);
+                    }
+
+                    break;
+                }
+
+                case SC_MUNMAP: {
+                    // The munmap system call
+
+                    // Unmaps a memory-mapped file, writing back its pages
+
+                    DEBUG('e', (char *)"Memory: Munmap call.\n");
+
+                    int32_t addr = g_machine->ReadIntRegister(4);
+
+                    if (g_current_thread->GetProcessOwner()->addrspace->Munmap(addr) == 0) {
+                        g_machine->WriteIntRegister(2, 0);
+
+                        g_syscall_error->SetMsg((char *)"", NO_ERROR);
+                    }
+
+                    else {
+                        g_machine->WriteIntRegister(2, ERROR);
+
+                        sprintf(msg, "0x%x", addr);
+
+                        g_syscall_error->SetMsg(msg, INVALID_MAPPING);
+                    }
+
+                    break;
+                }
+
+                case SC_FORK: {
+
+                    // The fork system call
+
+                    // Creates a copy of the current process, sharing its
+
+                    // pages copy-on-write
+
+                    DEBUG('e', (char *)"Process: Fork call.\n");
+
+                    char name[MAXSTRLEN];
+
+                    int error = NO_ERROR;
+
+                    Process *parent = g_current_thread->GetProcessOwner();
+
+                    Process *p = new Process(parent, &error);
+
+                    if (error != NO_ERROR) {
+
+                        g_machine->WriteIntRegister(2, ERROR);
+
+                        if (error == OUT_OF_MEMORY)
+
+                            g_syscall_error->SetMsg((char *)"", error);
+
+                        else
+
+                            g_syscall_error->SetMsg(parent->getName(), error);
+
+                        break;
+
+                    }
+
+                    snprintf(name, MAXSTRLEN, "master thread of forked process %s",
+
+                             parent->getName());
+
+                    Thread *ptThread = new Thread(name);
+
+                    int32_t tid = g_object_ids->AddObject(ptThread);
+
+                    error = ptThread->StartFork(p);
+
+                    if (error != NO_ERROR) {
+
+                        g_machine->WriteIntRegister(2, ERROR);
+
+                        g_syscall_error->SetMsg(name, error);
+
+                        break;
+
+                    }
+
+                    g_syscall_error->SetMsg((char *)"", NO_ERROR);
+
+                    g_machine->WriteIntRegister(2, tid);
+
+                    break;
+
                 }
 
                 case SC_NEW_THREAD: {
@@ -895,12 +1005,11 @@ void ExceptionHandler(ExceptionType exceptiontype, int vaddr)
                         g_syscall_error->SetMsg((char *)"", NO_ERROR);
                     }
 
-                    for (int i = 0; i < numread; i++)
+                    // Copy the buffer into the emulator memory
 
-                    {  //copy the buffer into the emulator memory
+                    if (numread > 0)
 
-                        g_machine->mmu->WriteMem(addr++, 1, buffer[i]);
-                    }
+                        g_machine->mmu->WriteMemBlock(addr, buffer, numread);
 
                     g_machine->WriteIntRegister(2, numread);
 
@@ -920,8 +1029,6 @@ void ExceptionHandler(ExceptionType exceptiontype, int vaddr)
 
                     int32_t f;
 
-                    uint32_t c;
-
                     addr = g_machine->ReadIntRegister(4);
 
                     size = g_machine->ReadIntRegister(5);
@@ -932,11 +1039,7 @@ void ExceptionHandler(ExceptionType exceptiontype, int vaddr)
 
                     char buffer[size];
 
-                    for (int i = 0; i < size; i++) {
-                        g_machine->mmu->ReadMem(addr++, 1, &c, false);
-
-                        buffer[i] = c;
-                    }
+                    g_machine->mmu->ReadMemBlock(addr, buffer, size);
 
                     int numwrite;
 
@@ -1230,6 +1333,24 @@ void ExceptionHandler(ExceptionType exceptiontype, int vaddr)
                     break;
                 }
 
+                case SC_SYNC: {
+                    // The Sync system call
+
+                    // Writes back the modified file headers, then the
+
+                    // dirty sectors of the buffer cache
+
+                    DEBUG('e', (char *)"Filesystem: Sync call.\n");
+
+                    g_header_table->Flush();
+
+                    g_buffer_cache->Flush();
+
+                    g_syscall_error->SetMsg((char *)"", NO_ERROR);
+
+                    break;
+                }
+
                 case SC_TTY_SEND: {
                     // the TtySend system call
 
@@ -1240,23 +1361,11 @@ void ExceptionHandler(ExceptionType exceptiontype, int vaddr)
                     if (g_cfg->ACIA != ACIA_NONE) {
                         int result;
 
-                        uint32_t c;
-
-                        int i;
-
                         uint32_t addr = g_machine->ReadIntRegister(4);
 
                         char buff[MAXSTRLEN];
 
-                        for (i = 0;; i++)
-
-                        {
-                            g_machine->mmu->ReadMem(addr + i, 1, &c, false);
-
-                            buff[i] = (char)c;
-
-                            if (buff[i] == '\0') break;
-                        }
+                        g_machine->mmu->ReadMemString(addr, buff, MAXSTRLEN);
 
                         result = g_acia_driver->TtySend(buff);
 
@@ -1285,8 +1394,6 @@ void ExceptionHandler(ExceptionType exceptiontype, int vaddr)
                     if (g_cfg->ACIA != ACIA_NONE) {
                         int result;
 
-                        int i = 0;
-
                         int addr = g_machine->ReadIntRegister(4);
 
                         int length = g_machine->ReadIntRegister(5);
@@ -1295,15 +1402,9 @@ void ExceptionHandler(ExceptionType exceptiontype, int vaddr)
 
                         result = g_acia_driver->TtyReceive(buff, length);
 
-                        while ((i <= length)) {
-                            g_machine->mmu->WriteMem(addr, 1, buff[i]);
-
-                            addr++;
-
-                            i++;
-                        }
+                        g_machine->mmu->WriteMemBlock(addr, buff, length + 1);
 
-                        g_machine->mmu->WriteMem(addr, 1, 0);
+                        g_machine->mmu->WriteMemBlock(addr + length + 1, "", 1);
 
                         g_machine->WriteIntRegister(2, result);
 
@@ -1348,6 +1449,12 @@ void ExceptionHandler(ExceptionType exceptiontype, int vaddr)
 
         case READONLY_EXCEPTION:
 
+            // Write to a page shared with another process since a Fork
+
+            if (g_page_fault_manager->CopyOnWrite(vaddr / g_cfg->PageSize) == NO_EXCEPTION)
+
+                break;
+
             printf("FATAL USER EXCEPTION (Thread %s, PC=0x%x):\n",
 
                    g_current_thread->GetName(), g_machine->ReadIntRegister(PC_REG));
@@ -1414,6 +1521,16 @@ void ExceptionHandler(ExceptionType exceptiontype, int vaddr)
 
             break;
 
+        case COPROCUNUSABLE_EXCEPTION:
+
+            // Lazy floating point context switch: the instruction is
+
+            // restarted once the thread owns the floating point registers
+
+            g_current_thread->TakeFPU();
+
+            break;
+
         case PAGEFAULT_EXCEPTION:
 
             ExceptionType e;
@@ -92,6 +92,10 @@ SyscallError::SyscallError() {
 
   msgs[NO_ACIA] = (char*)"no ACIA driver installed %s\n";
 
+
+
+  msgs[INVALID_MAPPING] = (char*)"no file mapped at address %s\n";
+
 }
 
 
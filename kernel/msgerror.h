@@ -94,6 +94,10 @@ enum
 
 
 
+  INVALID_MAPPING,
+
+
+
   NUMMSGERROR /* Must always be last */
 
 };
@@ -138,6 +138,76 @@ Process::Process(char *filename, int *err)
 
 
 
+//----------------------------------------------------------------------
+
+// Process::Process
+
+//!   Constructor. Create a copy of a process (Fork). The new address
+
+//      space shares all the pages of the parent one, each of them
+
+//      being copied on the first write of one of the processes.
+
+//
+
+//      \param parent the process to copy
+
+//      \param err error code, NO_ERROR if OK
+
+//----------------------------------------------------------------------
+
+Process::Process(Process *parent, int *err)
+
+{
+
+  numThreads=0;
+
+  *err = NO_ERROR;
+
+  DEBUG('t', (char *)"Fork process %s\n", parent->getName());
+
+
+
+  // Create a statistics object for the program
+
+  stat = g_stats->NewProcStat(parent->getName());
+
+
+
+  // Set process name
+
+  name = new char[strlen(parent->getName())+1];
+
+  strcpy(name, parent->getName());
+
+
+
+  // Open the executable again, for the pages not loaded yet
+
+  exec_file = g_file_system->Open(name);
+
+  if (exec_file == NULL) {
+
+    // NB : don't delete the stat object, so that statistics can
+
+    // be displayed after the end of the process
+
+    *err = INEXIST_FILE_ERROR;
+
+    return;
+
+  }
+
+
+
+  // Create the copy of the address space of the parent
+
+  addrspace = new AddrSpace(parent->addrspace, this, err);
+
+}
+
+
+
 //----------------------------------------------------------------------
 
 // Process::~Process
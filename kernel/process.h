@@ -60,6 +60,20 @@ public:
 
 
 
+  /*!
+
+   * Create a copy of a process (Fork), running the same program in
+
+   * an address space sharing its pages copy-on-write, without any
+
+   * thread in it.
+
+   */
+
+  Process(Process *parent, int *err);
+
+
+
   /*! Process destructor */
 
   ~Process();	
@@ -174,8 +174,6 @@ Scheduler::SwitchTo(Thread *nextThread)
 
     oldThread->SaveProcessorState();
 
-    oldThread->SaveSimulatorState();
-
     // Do the context switch if the two threads are different
 
     if (oldThread != g_current_thread) {
@@ -187,7 +185,11 @@ Scheduler::SwitchTo(Thread *nextThread)
 
         nextThread->RestoreProcessorState();
 
-        nextThread->RestoreSimulatorState();
+        // Switch to the stack of the new thread: returns once the old
+
+        // thread is switched back to
+
+        oldThread->SwitchSimulatorState(nextThread);
     }
 
     DEBUG('t', (char *)"Now in thread \"%s\" time %llu\n", g_current_thread->GetName(), g_stats->getTotalTicks());
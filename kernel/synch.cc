@@ -313,12 +313,15 @@ void Lock::Release() {
 #ifdef ETUDIANTS_TP
     auto previousInterruptStatus = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
    
-    this->free = true;
-    this->owner = NULL;
-
     Thread *toWake = (Thread *)(sleepqueue->Remove());
     if (toWake != NULL) {
+        // Hand the lock over to the waiter, so that no other thread
+        // can take it before the waiter runs
+        this->owner = toWake;
         g_scheduler->ReadyToRun(toWake);
+    } else {
+        this->free = true;
+        this->owner = NULL;
     }
 
     g_machine->interrupt->SetStatus(previousInterruptStatus);
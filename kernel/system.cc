@@ -42,6 +42,12 @@
 
 #include "filesys/filesys.h"
 
+#include "filesys/bufcache.h"
+
+#include "filesys/hdrtable.h"
+
+#include "filesys/namecache.h"
+
 #include "utility/objid.h"
 
 
@@ -90,6 +96,12 @@ DriverACIA *g_acia_driver;               //!< Serial line driver
 
 FileSystem  *g_file_system;                 //!< File system
 
+BufferCache *g_buffer_cache;                //!< Sector cache of the file system
+
+HeaderTable *g_header_table;                //!< In-core file headers
+
+NameCache *g_name_cache;                    //!< Cache of the directory entries
+
 OpenFileTable *g_open_file_table;           //!< Open File Table
 
 SwapManager *g_swap_manager;                //!< Management of swap area
@@ -302,7 +314,13 @@ Initialize(int argc, char **argv)
 
   // Create the device drivers
 
-  g_disk_driver = new DriverDisk((char*)"sem disk",(char*)"lock disk",g_machine->disk);
+  g_disk_driver = new DriverDisk((char*)"disk",g_machine->disk);
+
+  g_buffer_cache = new BufferCache(g_disk_driver,g_cfg->BufferCacheSize);
+
+  g_header_table = new HeaderTable;
+
+  g_name_cache = new NameCache(g_cfg->NameCacheSize);
 
   if (g_cfg->ACIA) g_acia_driver = new DriverACIA();
 
@@ -356,7 +374,7 @@ Initialize(int argc, char **argv)
 
   // Create the process (address space + statistics) context for this temporary thread
 
-  Process *rootProcess = new Process(NULL,&errStatus);
+  Process *rootProcess = new Process((char *)NULL,&errStatus);
 
   if (errStatus != NO_ERROR) {
 
@@ -390,6 +408,12 @@ Initialize(int argc, char **argv)
 
   ASSERT(g_current_thread == g_scheduler->FindNextToRun());
 
+
+
+  // Start the kernel thread keeping free physical pages in reserve
+
+  g_physical_mem_manager->StartPageOutDaemon(rootProcess);
+
   
 
   // Enable interrupts
@@ -440,6 +464,16 @@ Cleanup()
 
   // context switch, we have to free resources here.
 
+  // Write back the sectors kept dirty by the buffer cache first: the
+
+  // disk is still working
+
+  if (g_buffer_cache != NULL)
+
+    g_buffer_cache->FlushAtHalt();
+
+
+
   if (g_current_thread!=NULL) {
 
     delete g_current_thread;
@@ -458,6 +492,14 @@ Cleanup()
 
   }
 
+  if (g_cfg->PrintMachineState) {
+
+    g_machine->DumpState();
+
+    printf("Machine state checksum : 0x%x\n", g_machine->StateChecksum());
+
+  }
+
   delete g_disk_driver;
 
   delete g_console_driver;
@@ -468,6 +510,12 @@ Cleanup()
 
   delete g_file_system;
 
+  delete g_name_cache;
+
+  delete g_header_table;
+
+  delete g_buffer_cache;
+
   delete g_open_file_table;
 
   delete g_swap_manager;
@@ -85,6 +85,12 @@ class SwapManager;
 
 class FileSystem;
 
+class BufferCache;
+
+class HeaderTable;
+
+class NameCache;
+
 class OpenFileTable;
 
 class DriverDisk;
@@ -149,6 +155,12 @@ extern DriverACIA *g_acia_driver;               //!< Serial line driver
 
 extern FileSystem  *g_file_system;                 //!< File system
 
+extern BufferCache *g_buffer_cache;                //!< Sector cache of the file system
+
+extern HeaderTable *g_header_table;                //!< In-core file headers
+
+extern NameCache *g_name_cache;                    //!< Cache of the directory entries
+
 extern OpenFileTable *g_open_file_table;           //!< Open File Table
 
 extern SwapManager *g_swap_manager;                //!< Management of swap area
@@ -44,6 +44,10 @@
 
 // stack overflows
 
+//! Thread whose floating point registers are in the machine
+
+Thread *Thread::fpuOwner = NULL;
+
 //----------------------------------------------------------------------
 
 // Thread::Thread
@@ -115,6 +119,12 @@ Thread::~Thread()
 
         DeallocBoundedArray(simulator_context.stackBottom, simulator_context.stackSize);
 
+    // Our floating point registers need not be saved anymore
+
+    if (fpuOwner == this)
+
+        fpuOwner = NULL;
+
     // NB: the thread stack itself is not freed, we do not attempt to
 
     // reuse the address space dedicated to stack The corresponding
@@ -193,6 +203,102 @@ int Thread::Start(Process *owner,
 
 //----------------------------------------------------------------------
 
+// Thread::StartFork
+
+/*!  Attach a thread to a process created by a Fork, and prepare it to
+
+//   be dispatched on the CPU. The thread resumes the user code of the
+
+//   current thread, after its Fork system call, with 0 as the result
+
+//   of the system call.
+
+//
+
+// \return NO_ERROR on success, an error code on error
+
+*/
+
+//----------------------------------------------------------------------
+
+int Thread::StartFork(Process *owner)
+
+{
+    ASSERT(process == NULL);
+    auto previousInterruptStatus = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+    owner->numThreads++;
+    this->process = owner;
+
+    int8_t *simulSp = AllocBoundedArray(SIMULATORSTACKSIZE);
+    this->InitSimulatorContext(simulSp, SIMULATORSTACKSIZE);
+
+    // Same registers as the current thread, the floating point ones
+    // being in the machine if it owns the FPU
+    for (int i = 0; i < NUM_INT_REGS; i++)
+        thread_context.int_registers[i] = g_machine->int_registers[i];
+    for (int i = 0; i < NUM_FP_REGS; i++)
+        thread_context.float_registers[i] = (fpuOwner == g_current_thread)
+            ? g_machine->float_registers[i]
+            : g_current_thread->thread_context.float_registers[i];
+    thread_context.cc = (fpuOwner == g_current_thread)
+        ? g_machine->cc : g_current_thread->thread_context.cc;
+
+    // Return from the system call with 0 as result
+    thread_context.int_registers[2] = 0;
+    thread_context.int_registers[PREVPC_REG] = thread_context.int_registers[PC_REG];
+    thread_context.int_registers[PC_REG] = thread_context.int_registers[NEXTPC_REG];
+    thread_context.int_registers[NEXTPC_REG] += 4;
+
+    g_alive->Append(this);
+    g_scheduler->ReadyToRun(this);
+
+    g_machine->interrupt->SetStatus(previousInterruptStatus);
+    return NO_ERROR;
+}
+
+//----------------------------------------------------------------------
+
+// Thread::StartKernel
+
+/*!  Attach a kernel thread to a process, and prepare it to be
+
+//   dispatched on the CPU. The thread executes a kernel function, and
+
+//   never runs user code: it has no user stack.
+
+//
+
+// \param owner process owner (the kernel one)
+
+// \param func the function executed by the thread
+
+// \return NO_ERROR on success, an error code on error
+
+*/
+
+//----------------------------------------------------------------------
+
+int Thread::StartKernel(Process *owner, VoidNoArgFunctionPtr func)
+
+{
+    ASSERT(process == NULL);
+    auto previousInterruptStatus = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+    owner->numThreads++;
+    this->process = owner;
+
+    int8_t *simulSp = AllocBoundedArray(SIMULATORSTACKSIZE);
+    this->InitSimulatorContext(simulSp, SIMULATORSTACKSIZE, func);
+    this->InitThreadContext(0, 0, 0);
+
+    g_alive->Append(this);
+    g_scheduler->ReadyToRun(this);
+
+    g_machine->interrupt->SetStatus(previousInterruptStatus);
+    return NO_ERROR;
+}
+
+//----------------------------------------------------------------------
+
 // Thread::InitThreadContext
 
 /*!	Set the initial values for the thread contact
@@ -220,6 +326,12 @@ Thread::InitThreadContext(int32_t initialPCREG, int32_t initialSP, int32_t arg)
 
         thread_context.int_registers[i] = 0;
 
+    for (i = 0; i < NUM_FP_REGS; i++)
+
+        thread_context.float_registers[i] = 0;
+
+    thread_context.cc = 0;
+
     // Initial program counter -- must be location of "Start"
 
     thread_context.int_registers[PC_REG] = initialPCREG;
@@ -290,6 +402,10 @@ void StartThreadExecution(void) {
 
 // 	\param base_stack_addr is the lowest address of the kernel stack
 
+// 	\param func is the function executed by the thread (StartThreadExecution
+
+//	for the threads running user code)
+
 //
 
 //----------------------------------------------------------------------
@@ -300,7 +416,9 @@ void
 
 Thread::InitSimulatorContext(int8_t *base_stack_addr,
 
-                             unsigned long int stack_size)
+                             unsigned long int stack_size,
+
+                             VoidNoArgFunctionPtr func)
 
 {
     DEBUG('t', (char *)"Init simulator context \"%s\" with stack=%p\n",
@@ -309,29 +427,13 @@ Thread::InitSimulatorContext(int8_t *base_stack_addr,
 
     ASSERT(base_stack_addr != NULL);
 
-    // Fill in buf with the current context
+    // Fill in buf such that StartThreadExecution will be called
 
-    // and then fill busf such that StartThreadExecution
+    // on the thread stack when the thread is switched to
 
-    // will be called when a setcontext will be made on buf
+    InitHostContext(&(simulator_context.buf), base_stack_addr, stack_size,
 
-    // NB: the gcc implementation of makecontext
-
-    //     interprets ss_sp as the stack BASE and not stack BOTTOM
-
-    //     (may not be portable to other architectures/compilers)
-
-    ASSERT(getcontext(&(simulator_context.buf)) == 0);
-
-    simulator_context.buf.uc_stack.ss_sp = base_stack_addr;
-
-    simulator_context.buf.uc_stack.ss_size = stack_size;
-
-    simulator_context.buf.uc_stack.ss_flags = 0;
-
-    simulator_context.buf.uc_link = NULL;
-
-    makecontext(&simulator_context.buf, StartThreadExecution, 0);
+                    func);
 
     // Setup kernel stack parameters for low-level context switch
 
@@ -445,6 +547,12 @@ Thread::Finish()
     Sleep();
 #endif
 #ifdef ETUDIANTS_TP
+    // The last thread of a process writes back its memory-mapped
+    // files: the process is deleted in the context of another thread,
+    // which cannot wait for the disk
+    if ((process != NULL) && (process->numThreads == 1) && (process->addrspace != NULL))
+        process->addrspace->UnmapAllFiles();
+
     auto previousInterruptStatus = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
 
     g_thread_to_be_destroyed = this;
@@ -613,19 +721,14 @@ Thread::SaveProcessorState()
     exit(-1);
 #endif
 #ifdef ETUDIANTS_TP
-    auto previousInterruptStatus = g_machine->interrupt->GetStatus();
-    g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+    // Called by Scheduler::SwitchTo, interrupts are already disabled
+    ASSERT(g_machine->interrupt->GetStatus() == INTERRUPTS_OFF);
 
-    for (int i = 0; i < 32; i++) {
-        this->thread_context.float_registers[i] = g_machine->float_registers[i];
-    }
-    for (int i = 0; i < 40; i++) {
+    // The floating point registers stay in the machine, they are
+    // saved by TakeFPU when another thread uses them
+    for (int i = 0; i < NUM_INT_REGS; i++) {
         this->thread_context.int_registers[i] = g_machine->int_registers[i];
     }
-    this->thread_context.cc = g_machine->cc;
-
-    g_machine->interrupt->SetStatus(previousInterruptStatus);
-    
 #endif
 }
 
@@ -650,28 +753,33 @@ Thread::RestoreProcessorState()
     exit(-1);
 #endif
 #ifdef ETUDIANTS_TP
-    auto previousInterruptStatus = g_machine->interrupt->GetStatus();
-    g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+    // Called by Scheduler::SwitchTo, interrupts are already disabled
+    ASSERT(g_machine->interrupt->GetStatus() == INTERRUPTS_OFF);
     g_machine->mmu->translationTable = this->GetProcessOwner()->addrspace->translationTable;
-    
-    for (int i = 0; i < 32; i++) {
-        g_machine->float_registers[i] = this->thread_context.float_registers[i];
-    }
-    for (int i = 0; i < 40; i++) {
+
+    for (int i = 0; i < NUM_INT_REGS; i++) {
         g_machine->int_registers[i] = this->thread_context.int_registers[i];
     }
-    g_machine->cc = this->thread_context.cc;
-
-    g_machine->interrupt->SetStatus(previousInterruptStatus);
 
+    // The floating point registers are only loaded on the first
+    // floating point instruction (see TakeFPU)
+    g_machine->fpuEnabled = (fpuOwner == this);
 #endif
 }
 
 //----------------------------------------------------------------------
 
-// Thread::SaveSimulatorState
+// Thread::TakeFPU
+
+/*!	Give the floating point registers of the machine to this thread.
+
+//	Called on the first floating point instruction executed by the
+
+//	thread since it was switched to (COPROCUNUSABLE_EXCEPTION): the
 
-/*!	Save the simulator state.
+//	registers of their previous owner are saved in its context, and
+
+//	ours are loaded.
 
 */
 
@@ -679,17 +787,49 @@ Thread::RestoreProcessorState()
 
 void
 
-Thread::SaveSimulatorState()
+Thread::TakeFPU()
 
 {
-    getcontext(&(simulator_context.buf));
+
+    if (fpuOwner != this) {
+
+        if (fpuOwner != NULL) {
+
+            for (int i = 0; i < NUM_FP_REGS; i++)
+
+                fpuOwner->thread_context.float_registers[i] = g_machine->float_registers[i];
+
+            fpuOwner->thread_context.cc = g_machine->cc;
+
+        }
+
+        for (int i = 0; i < NUM_FP_REGS; i++)
+
+            g_machine->float_registers[i] = thread_context.float_registers[i];
+
+        g_machine->cc = thread_context.cc;
+
+        fpuOwner = this;
+
+        g_stats->incrFPUSwitches();
+
+    }
+
+    g_machine->fpuEnabled = true;
+
 }
 
 //----------------------------------------------------------------------
 
-// Thread::RestoreSimulatorState
+// Thread::SwitchSimulatorState
+
+/*!	Save the simulator state, and resume the simulator state of
 
-/*!	Restore simulator state.
+//	another thread. Returns when this thread is switched back to.
+
+//
+
+//	\param nextThread the thread to switch to
 
 */
 
@@ -697,8 +837,10 @@ Thread::SaveSimulatorState()
 
 void
 
-Thread::RestoreSimulatorState()
+Thread::SwitchSimulatorState(Thread *nextThread)
 
 {
-    setcontext(&(simulator_context.buf));
+
+    SwitchHostContext(&(simulator_context.buf), &(nextThread->simulator_context.buf));
+
 }
@@ -52,8 +52,6 @@ class Thread;
 
 #include "utility/stats.h"
 
-#include <ucontext.h> 
-
 
 
 // Size of the simulator's execution stack
@@ -68,6 +66,12 @@ extern void ThreadPrint(long arg);
 
 
 
+// Entry point of the threads running user code, starting the simulator
+
+extern void StartThreadExecution(void);
+
+
+
 class Semaphore;
 
 class Process;
@@ -80,7 +84,7 @@ class Process;
 
 typedef struct {
 
-  ucontext_t buf;
+  HostContext buf;
 
   int8_t *stackBottom;
 
@@ -150,6 +154,22 @@ public:
 
 
 
+  //! Start a thread in a process created by a Fork, as a copy of the
+
+  //  current thread (return NoError on success)
+
+  int StartFork(Process *owner);
+
+
+
+  //! Start a kernel thread executing func, without any user code
+
+  //  (return NoError on success)
+
+  int StartKernel(Process *owner, VoidNoArgFunctionPtr func);
+
+
+
   //! Wait for another thread to finish its execution
 
   void Join(Thread *Idthread);
@@ -184,11 +204,13 @@ public:
 
   //  values such that the low-level context switch executes function
 
-  //  StartThreadExecution.
+  //  StartThreadExecution (or func for a kernel thread).
 
   void InitSimulatorContext(int8_t* stack_addr,
 
-			 unsigned long int stack_size);
+			 unsigned long int stack_size,
+
+			 VoidNoArgFunctionPtr func = StartThreadExecution);
 
 
 
@@ -212,15 +234,19 @@ public:
 
 
 
-  //! Save the state of the Nachos simulator.
+  //! Give the floating point registers to this thread, on its first
 
-  void SaveSimulatorState();	
+  //  floating point instruction since it was switched to
 
-    
+  void TakeFPU();
+
+
+
+  //! Save the state of the Nachos simulator, and resume the
 
-  //! Restore Nachos simulator state.
+  //  simulator state of another thread
 
-  void RestoreSimulatorState();
+  void SwitchSimulatorState(Thread *nextThread);
 
 
 
@@ -250,12 +276,22 @@ protected:
 
 
 
-  //! Thread context
+  //! Thread context (the floating point registers are only up to
+
+  //  date when the thread does not own the FPU)
 
   threadContextT thread_context;
 
 
 
+  //! Thread whose floating point registers are in the machine, NULL
+
+  //  if none
+
+  static Thread *fpuOwner;
+
+
+
 public:
 
   //! signature to make sure the thread is in the correct state
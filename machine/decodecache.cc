@@ -0,0 +1,360 @@
+/*! \file decodecache.cc
+
+// \brief Cache of decoded instructions
+
+//
+
+// DO NOT CHANGE -- part of the machine emulation
+
+//
+
+//  Copyright (c) 1999-2000 INSA de Rennes.
+
+//  All rights reserved.
+
+//  See copyright_insa.h for copyright notice and limitation
+
+//  of liability and disclaimer of warranty provisions.
+
+//
+
+*/
+
+
+
+#include <string.h>
+
+
+
+#include "machine/machine.h"
+
+#include "machine/decodecache.h"
+
+
+
+//----------------------------------------------------------------------
+
+// DecodeCache::DecodeCache
+
+/*!  Constructor. Allocate one slot per instruction word of the
+
+//   main memory, all of them initially empty.
+
+//
+
+//   \param nbPages number of physical pages of the machine
+
+//   \param pageSize size of a physical page in bytes (power of 2)
+
+*/
+
+//----------------------------------------------------------------------
+
+DecodeCache::DecodeCache(int nbPages, int pageSize) {
+
+  numPages = nbPages;
+
+  pageShift = 0;
+
+  while ((1 << pageShift) < pageSize) pageShift++;
+
+  ASSERT((1 << pageShift) == pageSize);
+
+  instrPerPage = pageSize / 4;
+
+
+
+  decoded = new Instruction[numPages * instrPerPage];
+
+  valid = new bool[numPages * instrPerPage];
+
+  pageCached = new bool[numPages];
+
+  memset(valid, 0, numPages * instrPerPage * sizeof(bool));
+
+  memset(pageCached, 0, numPages * sizeof(bool));
+
+  handlers = new InstrHandler[numPages * instrPerPage];
+
+  blockLen = new uint16_t[numPages * instrPerPage];
+
+  memset(blockLen, 0, numPages * instrPerPage * sizeof(uint16_t));
+
+  scratch = new Instruction;
+
+
+
+  hits = misses = invalidations = blocks = 0;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// DecodeCache::~DecodeCache
+
+/*!  Destructor. De-allocate the cache
+
+*/
+
+//----------------------------------------------------------------------
+
+DecodeCache::~DecodeCache() {
+
+  delete [] decoded;
+
+  delete [] valid;
+
+  delete [] pageCached;
+
+  delete [] handlers;
+
+  delete [] blockLen;
+
+  delete scratch;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// DecodeCache::Fetch
+
+/*!  Return the decoded form of the instruction stored at a physical
+
+//   address. The instruction is read from main memory and decoded
+
+//   if it is not in the cache yet.
+
+//
+
+//   \param physAddr physical address of the instruction
+
+//   \return the decoded instruction. It must not be modified by the
+
+//           caller, and is only valid until the next call.
+
+*/
+
+//----------------------------------------------------------------------
+
+Instruction *DecodeCache::Fetch(uint32_t physAddr) {
+
+  uint32_t raw;
+
+  Instruction *instr;
+
+
+
+  // Mis-aligned instructions are not cached
+
+  if (physAddr & 0x3) {
+
+    raw = *(uint32_t *) &g_machine->mainMemory[physAddr];
+
+    scratch->value = WordToHost(raw);
+
+    scratch->Decode();
+
+    misses++;
+
+    return scratch;
+
+  }
+
+
+
+  int slot = physAddr >> 2;
+
+  instr = &decoded[slot];
+
+  if (valid[slot]) {
+
+    hits++;
+
+    return instr;
+
+  }
+
+
+
+  misses++;
+
+  return Decode(slot);
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// DecodeCache::FetchBlock
+
+/*!  Return the basic block starting at a physical address, for the
+
+//   threaded execution engine. A block is made of consecutive
+
+//   instructions of the same physical page, and ends after the delay
+
+//   slot of the first branch. The instructions of the block are
+
+//   decoded, and their handlers resolved, on the first call.
+
+//
+
+//   \param physAddr physical address of the first instruction
+
+//   \param instrs set to the decoded instructions of the block
+
+//   \param handlers set to the handlers of the instructions
+
+//   \return the number of instructions in the block (at least 1)
+
+*/
+
+//----------------------------------------------------------------------
+
+int DecodeCache::FetchBlock(uint32_t physAddr, Instruction **instrs,
+
+			    InstrHandler **code) {
+
+  ASSERT((physAddr & 0x3) == 0);
+
+  int first = physAddr >> 2;
+
+
+
+  if (!valid[first] || (blockLen[first] == 0)) {
+
+    int end = ((physAddr >> pageShift) + 1) * instrPerPage;
+
+    int slot;
+
+    bool endsBlock = false;
+
+    bool isBranch;
+
+
+
+    // Decode the block and resolve the handlers, up to the delay
+
+    // slot of the first branch or the end of the page
+
+    for (slot = first; slot < end; ) {
+
+      if (!valid[slot]) {
+
+	misses++;
+
+	Decode(slot);
+
+      }
+
+      handlers[slot] = ResolveHandler(decoded[slot].opCode, &isBranch);
+
+      slot++;
+
+      if (endsBlock) break;
+
+      endsBlock = isBranch;
+
+    }
+
+    blockLen[first] = slot - first;
+
+    blocks++;
+
+  }
+
+  else hits++;
+
+
+
+  *instrs = &decoded[first];
+
+  *code = &handlers[first];
+
+  return blockLen[first];
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// DecodeCache::Decode
+
+/*!  Read an instruction from main memory and decode it in its slot.
+
+//
+
+//   \param slot the slot number (physical address divided by 4)
+
+//   \return the decoded instruction
+
+*/
+
+//----------------------------------------------------------------------
+
+Instruction *DecodeCache::Decode(int slot) {
+
+  Instruction *instr = &decoded[slot];
+
+  uint32_t raw = *(uint32_t *) &g_machine->mainMemory[slot << 2];
+
+
+
+  instr->value = WordToHost(raw);
+
+  instr->Decode();
+
+  valid[slot] = true;
+
+  blockLen[slot] = 0;
+
+  pageCached[(slot << 2) >> pageShift] = true;
+
+  return instr;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// DecodeCache::InvalidatePage
+
+/*!  Forget all the decoded instructions of a physical page. Must be
+
+//   called each time the content of the page is changed without
+
+//   going through the MMU (disk transfers, page replacement).
+
+//
+
+//   \param physPage the physical page number
+
+*/
+
+//----------------------------------------------------------------------
+
+void DecodeCache::InvalidatePage(int physPage) {
+
+  ASSERT((physPage >= 0) && (physPage < numPages));
+
+  if (!pageCached[physPage]) return;
+
+  memset(&valid[physPage * instrPerPage], 0, instrPerPage * sizeof(bool));
+
+  memset(&blockLen[physPage * instrPerPage], 0,
+
+	 instrPerPage * sizeof(uint16_t));
+
+  pageCached[physPage] = false;
+
+  invalidations++;
+
+}
+
@@ -0,0 +1,218 @@
+/*! \file decodecache.h
+
+   \brief Data structures for the decoded instruction cache
+
+
+
+   The MIPS simulator fetches and decodes every instruction it executes.
+
+   Since user code is seldom modified, the decoded form of each
+
+   instruction word is kept in a cache indexed by physical address,
+
+   so that a fetch only has to translate the program counter.
+
+
+
+   Entries are filled lazily on the first fetch of an instruction.
+
+   All the entries of a physical page are forgotten when the page is
+
+   written by the MMU, or when the physical page is given to another
+
+   virtual page by the physical memory manager.
+
+
+
+   The cache also holds the threaded code used by the threaded
+
+   execution engine (see threaded.cc): each entry is associated with
+
+   the handler executing the instruction, and with the length of the
+
+   basic block starting at this entry.
+
+
+
+    DO NOT CHANGE -- part of the machine emulation
+
+
+
+    Copyright (c) 1999-2000 INSA de Rennes.
+
+    All rights reserved.
+
+    See copyright_insa.h for copyright notice and limitation
+
+    of liability and disclaimer of warranty provisions.
+
+*/
+
+
+
+#ifndef DECODECACHE_H
+
+#define DECODECACHE_H
+
+
+
+#include <stdint.h>
+
+
+
+class Instruction;
+
+class Machine;
+
+
+
+//! Function executing a decoded instruction in the threaded engine.
+
+//! Returns false if an exception was raised by the instruction.
+
+typedef bool (*InstrHandler)(Machine *machine, Instruction *instr);
+
+
+
+//! Return the threaded engine handler of an opcode. endsBlock is set
+
+//! if the instruction is a branch, ending a basic block after its
+
+//! delay slot. Defined in threaded.cc
+
+extern InstrHandler ResolveHandler(int opCode, bool *endsBlock);
+
+
+
+/*! \brief Defines a cache of decoded instructions, per physical page
+
+*/
+
+class DecodeCache {
+
+public:
+
+  DecodeCache(int nbPages, int pageSize);
+
+  				//!< Initialize an empty cache for
+
+				//!< nbPages physical pages
+
+
+
+  ~DecodeCache();
+
+
+
+  Instruction *Fetch(uint32_t physAddr);
+
+  				//!< Return the decoded instruction stored at
+
+				//!< physAddr in main memory, decoding it
+
+				//!< if it is not in the cache yet
+
+
+
+  int FetchBlock(uint32_t physAddr, Instruction **instrs,
+
+		 InstrHandler **code);
+
+  				//!< Return the basic block starting at
+
+				//!< physAddr, as arrays of decoded
+
+				//!< instructions and handlers, and its length
+
+
+
+  //! true if the instruction at physAddr is still in the cache
+
+  bool IsValid(uint32_t physAddr) { return valid[physAddr >> 2]; }
+
+
+
+  void InvalidatePage(int physPage);
+
+  				//!< Forget every decoded instruction of
+
+				//!< a physical page
+
+
+
+  //! Called on every write to main memory by the MMU
+
+  void NotifyWrite(uint32_t physAddr)
+
+    { if (pageCached[physAddr >> pageShift])
+
+	InvalidatePage(physAddr >> pageShift); }
+
+
+
+  // Counters, for statistics
+
+  uint64_t getHits() { return hits; }
+
+  uint64_t getMisses() { return misses; }
+
+  uint64_t getInvalidations() { return invalidations; }
+
+  uint64_t getBlocks() { return blocks; }
+
+
+
+private:
+
+  int numPages;			//!< Number of physical pages
+
+  int pageShift;		//!< log2 of the page size
+
+  int instrPerPage;		//!< Number of instruction words per page
+
+
+
+  Instruction *decoded;		//!< Decoded instructions, one slot per
+
+				//!< instruction word of main memory
+
+  bool *valid;			//!< true if the corresponding slot is filled
+
+  bool *pageCached;		//!< true if at least one slot of the page
+
+				//!< is filled
+
+
+
+  InstrHandler *handlers;	//!< Threaded engine handler of each slot
+
+  uint16_t *blockLen;		//!< Length of the basic block starting
+
+				//!< at each slot, 0 if not known yet
+
+
+
+  Instruction *scratch;		//!< Used for mis-aligned fetches, which
+
+				//!< are decoded but never cached
+
+
+
+  uint64_t hits;		//!< Fetches served by the cache
+
+  uint64_t misses;		//!< Fetches that needed a decode
+
+  uint64_t invalidations;	//!< Number of page invalidations
+
+  uint64_t blocks;		//!< Number of basic blocks translated
+
+
+
+  Instruction *Decode(int slot);	//!< Fill-in a slot from main memory
+
+};
+
+
+
+#endif // DECODECACHE_H
+
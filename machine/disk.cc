@@ -212,6 +212,34 @@ PrintSector (bool writing, int sector, char *data)
 
 /*!	Simulate a request to read a single disk sector
 
+//
+
+//	\param sectorNumber the disk sector to read
+
+//	\param data the buffer to hold the incoming bytes
+
+*/
+
+//----------------------------------------------------------------------
+
+void
+
+Disk::ReadRequest(int sectorNumber, char* data)
+
+{
+
+    ReadRequest(sectorNumber, &data, 1);
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// Disk::ReadRequest
+
+/*!	Simulate a request to read a run of consecutive disk sectors
+
 //	   Do the read immediately to the UNIX file
 
 //	   Set up an interrupt handler to be called later,
@@ -222,15 +250,19 @@ PrintSector (bool writing, int sector, char *data)
 
 //
 
-//	Note that a disk only allows an entire sector to be read,
+//	Note that a disk only allows entire sectors to be read,
 
 //	not part of a sector.
 
 //
 
-//	\param sectorNumber the disk sector to read
+//	\param sectorNumber the first disk sector to read
 
-//	\param data the buffer to hold the incoming bytes
+//	\param buffers the buffers to hold the incoming bytes, one
+
+//	       per sector (scatter-gather list)
+
+//	\param numSectors the number of sectors to read
 
 */
 
@@ -238,11 +270,11 @@ PrintSector (bool writing, int sector, char *data)
 
 void
 
-Disk::ReadRequest(int sectorNumber, char* data)
+Disk::ReadRequest(int sectorNumber, char** buffers, int numSectors)
 
 {
 
-    int ticks = ComputeLatency(sectorNumber, false);
+    int ticks = ComputeLatency(sectorNumber, false, numSectors);
 
 
 
@@ -252,13 +284,17 @@ Disk::ReadRequest(int sectorNumber, char* data)
 
 
 
-    // Sanity check of the sector number
+    // Sanity check of the sector numbers
 
-    ASSERT((sectorNumber >= 0) && (sectorNumber < NUM_SECTORS))
+    ASSERT((sectorNumber >= 0) && (numSectors > 0)
 
+	   && (sectorNumber + numSectors <= NUM_SECTORS));
 
 
-    DEBUG('h', (char *)"Reading from sector %d\n", sectorNumber);
+
+    DEBUG('h', (char *)"Reading %d sectors from sector %d\n", numSectors,
+
+	  sectorNumber);
 
 
 
@@ -266,11 +302,15 @@ Disk::ReadRequest(int sectorNumber, char* data)
 
     Lseek(fileno, g_cfg->SectorSize * sectorNumber + g_cfg->MagicSize, 0);
 
-    Read(fileno, data, g_cfg->SectorSize);
+    for (int i = 0; i < numSectors; i++) {
+
+	Read(fileno, buffers[i], g_cfg->SectorSize);
 
-    if (DebugIsEnabled('h'))
+	if (DebugIsEnabled('h'))
 
-	PrintSector(false, sectorNumber, data);
+	    PrintSector(false, sectorNumber + i, buffers[i]);
+
+    }
 
     
 
@@ -278,7 +318,7 @@ Disk::ReadRequest(int sectorNumber, char* data)
 
     active = true;
 
-    UpdateLast(sectorNumber);
+    UpdateLast(sectorNumber, numSectors, ticks);
 
     
 
@@ -302,6 +342,36 @@ Disk::ReadRequest(int sectorNumber, char* data)
 
 /*!	Simulate a request to write a single disk sector
 
+//
+
+//	\param sectorNumber the disk sector to write
+
+//	\param data the bytes to be written
+
+*/
+
+//----------------------------------------------------------------------
+
+
+
+void
+
+Disk::WriteRequest(int sectorNumber, char* data)
+
+{
+
+    WriteRequest(sectorNumber, &data, 1);
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// Disk::WriteRequest
+
+/*!	Simulate a request to write a run of consecutive disk sectors
+
 //	   Do the write immediately to the UNIX file
 
 //	   Set up an interrupt handler to be called later,
@@ -312,15 +382,19 @@ Disk::ReadRequest(int sectorNumber, char* data)
 
 //
 
-//	Note that a disk only allows an entire sector to be written,
+//	Note that a disk only allows entire sectors to be written,
 
 //	not part of a sector.
 
 //
 
-//	\param sectorNumber the disk sector to write
+//	\param sectorNumber the first disk sector to write
 
-//	\param data the bytes to be written
+//	\param buffers the bytes to be written, one buffer per sector
+
+//	       (scatter-gather list)
+
+//	\param numSectors the number of sectors to write
 
 */
 
@@ -330,11 +404,11 @@ Disk::ReadRequest(int sectorNumber, char* data)
 
 void
 
-Disk::WriteRequest(int sectorNumber, char* data)
+Disk::WriteRequest(int sectorNumber, char** buffers, int numSectors)
 
 {
 
-    int ticks = ComputeLatency(sectorNumber, true);
+    int ticks = ComputeLatency(sectorNumber, true, numSectors);
 
 
 
@@ -344,13 +418,17 @@ Disk::WriteRequest(int sectorNumber, char* data)
 
 
 
-    // Sanity check of the sector number
+    // Sanity check of the sector numbers
+
+    ASSERT((sectorNumber >= 0) && (numSectors > 0)
 
-    ASSERT((sectorNumber >= 0) && (sectorNumber < NUM_SECTORS));
+	   && (sectorNumber + numSectors <= NUM_SECTORS));
 
     
 
-    DEBUG('h', (char *)"Writing to sector %d\n", sectorNumber);
+    DEBUG('h', (char *)"Writing %d sectors to sector %d\n", numSectors,
+
+	  sectorNumber);
 
 
 
@@ -358,11 +436,15 @@ Disk::WriteRequest(int sectorNumber, char* data)
 
     Lseek(fileno, g_cfg->SectorSize * sectorNumber + g_cfg->MagicSize, 0);
 
-    WriteFile(fileno, data, g_cfg->SectorSize);
+    for (int i = 0; i < numSectors; i++) {
+
+	WriteFile(fileno, buffers[i], g_cfg->SectorSize);
 
-    if (DebugIsEnabled('h'))
+	if (DebugIsEnabled('h'))
 
-	PrintSector(true, sectorNumber, data);
+	    PrintSector(true, sectorNumber + i, buffers[i]);
+
+    }
 
     
 
@@ -370,7 +452,7 @@ Disk::WriteRequest(int sectorNumber, char* data)
 
     active = true;
 
-    UpdateLast(sectorNumber);
+    UpdateLast(sectorNumber, numSectors, ticks);
 
 
 
@@ -522,9 +604,9 @@ Disk::ModuloDiff(int to, Time from)
 
 // Disk::ComputeLatency()
 
-/*! 	Return how long will it take to read/write a disk sector, from
+/*! 	Return how long will it take to read/write a run of disk sectors,
 
-//	the current position of the disk head.
+//	from the current position of the disk head.
 
 //
 
@@ -556,6 +638,14 @@ Disk::ModuloDiff(int to, Time from)
 
 //   	a new track.
 
+//
+
+//	The following sectors of a run pass under the head one after the
+
+//	other. When the run goes on the next track, the head seeks one
+
+//	track and waits for the first sector of this track.
+
 */
 
 //----------------------------------------------------------------------
@@ -564,7 +654,7 @@ Disk::ModuloDiff(int to, Time from)
 
 int
 
-Disk::ComputeLatency(int newSector, bool writing)
+Disk::ComputeLatency(int newSector, bool writing, int numSectors)
 
 {
 
@@ -572,10 +662,16 @@ Disk::ComputeLatency(int newSector, bool writing)
 
     int seek = TimeToSeek(newSector, &rotation);
 
-    Time timeAfter = g_stats->getTotalTicks() + seek + rotation;
+    Time now = g_stats->getTotalTicks();
+
+    Time timeAfter = now + seek + rotation;
 
     Time rot_time = nano_to_cycles(ROTATION_TIME,g_cfg->ProcessorFrequency);
 
+    Time seek_time = nano_to_cycles(SEEK_TIME,g_cfg->ProcessorFrequency);
+
+    Time end;
+
 
 
 #ifndef NOTRACKBUF	// turn this on if you don't want the track buffer stuff
@@ -588,23 +684,47 @@ Disk::ComputeLatency(int newSector, bool writing)
 
 	     		> (Time)ModuloDiff(newSector, bufferInit / rot_time))) {
 
-        DEBUG('h', (char *)"Request latency = %d\n",rot_time);
-
-	return rot_time; // time to transfer sector from the track buffer
+	end = now + rot_time; // time to transfer sector from the track buffer
 
     }
 
+    else
+
 #endif // NOTRACKBUF
 
+    {
+
+	rotation += ModuloDiff(newSector, timeAfter / rot_time) * rot_time;
+
+	end = now + seek + rotation + rot_time;
+
+    }
+
+
+
+    for (int sector = newSector + 1; sector < newSector + numSectors; sector++) {
+
+	if ((sector % SECTORS_PER_TRACK) == 0) {
+
+	    end += seek_time;
 
+	    if ((end % rot_time) > 0)
 
-    rotation += ModuloDiff(newSector, timeAfter / rot_time) * rot_time;
+		end += rot_time - (end % rot_time);
 
+	    end += ModuloDiff(sector, end / rot_time) * rot_time;
 
+	}
 
-    DEBUG('h', (char *)"Request latency = %d\n", seek + rotation + rot_time);
+	end += rot_time;
 
-    return(seek + rotation + rot_time);
+    }
+
+
+
+    DEBUG('h', (char *)"Request latency = %d\n", (int)(end - now));
+
+    return (int)(end - now);
 
 }
 
@@ -618,7 +738,11 @@ Disk::ComputeLatency(int newSector, bool writing)
 
 //	what is in the track buffer.
 
-// \param newSector accessed sector
+// \param newSector first accessed sector
+
+// \param numSectors number of sectors accessed
+
+// \param ticks latency of the request
 
 */
 
@@ -626,7 +750,7 @@ Disk::ComputeLatency(int newSector, bool writing)
 
 void
 
-Disk::UpdateLast(int newSector)
+Disk::UpdateLast(int newSector, int numSectors, int ticks)
 
 {
 
@@ -634,13 +758,25 @@ Disk::UpdateLast(int newSector)
 
     int seek = TimeToSeek(newSector, &rotate);
 
+    int last = newSector + numSectors - 1;
+
     
 
     if (seek != 0)
 
 	bufferInit = g_stats->getTotalTicks() + seek + rotate;
 
-    lastSector = newSector;
+    // A run crossing tracks ends on the track of its last sector
+
+    if ((last / SECTORS_PER_TRACK) != (newSector / SECTORS_PER_TRACK))
+
+	bufferInit = g_stats->getTotalTicks() + ticks
+
+	  - ((last % SECTORS_PER_TRACK) + 1)
+
+	    * nano_to_cycles(ROTATION_TIME,g_cfg->ProcessorFrequency);
+
+    lastSector = last;
 
 }
 
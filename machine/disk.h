@@ -110,6 +110,16 @@
 
 // The track buffer simulation can be disabled by compiling with -DNOTRACKBUF
 
+//
+
+// A request may transfer a run of consecutive sectors, from or to
+
+// separate buffers (scatter-gather): it costs one seek, then the
+
+// sectors are transferred as they pass under the head, and a single
+
+// interrupt signals the end of the whole run.
+
 */
 
 class Disk {
@@ -142,19 +152,35 @@ class Disk {
 
 
 
+    void ReadRequest(int sectorNumber, char** buffers, int numSectors);
+
+    					/*!< Read/write a run of consecutive
+
+					     sectors, each one in its own
+
+					     buffer, with a single interrupt
+
+					     at the end of the transfer. */
+
+    void WriteRequest(int sectorNumber, char** buffers, int numSectors);
+
+
+
     void HandleInterrupt();		/*!< Interrupt handler, invoked when
 
 					     disk request finishes. */
 
 
 
-    int ComputeLatency(int newSector, bool writing);	
+    int ComputeLatency(int newSector, bool writing, int numSectors = 1);
 
     					/*!< Return how long a request to 
 
-					newSector will take: 
+					numSectors sectors from newSector
+
+					will take: (seek + rotational delay
 
-					(seek + rotational delay + transfer) */
+					+ transfer) */
 
 
 
@@ -182,7 +208,7 @@ class Disk {
 
     int ModuloDiff(int to, Time from);        // # sectors between to and from
 
-    void UpdateLast(int newSector);
+    void UpdateLast(int newSector, int numSectors, int ticks);
 
 };
 
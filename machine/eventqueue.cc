@@ -0,0 +1,372 @@
+/*! \file eventqueue.cc
+
+// \brief Queue of pending interrupts
+
+//
+
+// DO NOT CHANGE -- part of the machine emulation
+
+//
+
+//  Copyright (c) 1999-2000 INSA de Rennes.
+
+//  All rights reserved.
+
+//  See copyright_insa.h for copyright notice and limitation
+
+//  of liability and disclaimer of warranty provisions.
+
+//
+
+*/
+
+
+
+#include <stdlib.h>
+
+
+
+#include "machine/eventqueue.h"
+
+
+
+//! Initial size of the heap array
+
+#define EVENTQUEUE_INITIAL_CAPACITY 16
+
+
+
+//----------------------------------------------------------------------
+
+// Before
+
+/*!  Order of the interrupts in the queue: by time, then by insertion
+
+//   rank.
+
+*/
+
+//----------------------------------------------------------------------
+
+static inline bool Before(PendingInterrupt *a, PendingInterrupt *b) {
+
+  return ((a->when < b->when)
+
+	  || ((a->when == b->when) && (a->rank < b->rank)));
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// EventQueue::EventQueue
+
+/*!  Constructor. Initialize an empty queue
+
+*/
+
+//----------------------------------------------------------------------
+
+EventQueue::EventQueue() {
+
+  capacity = EVENTQUEUE_INITIAL_CAPACITY;
+
+  heap = new PendingInterrupt[capacity];
+
+  size = 0;
+
+  nextRank = 0;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// EventQueue::~EventQueue
+
+/*!  Destructor. De-allocate the queue, pending interrupts included
+
+*/
+
+//----------------------------------------------------------------------
+
+EventQueue::~EventQueue() {
+
+  delete [] heap;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// EventQueue::Insert
+
+/*!  Schedule an interrupt. It will occur after all the interrupts
+
+//   scheduled before it at the same time.
+
+//
+
+//   \param handler is the procedure to call when the interrupt occurs
+
+//   \param arg is the argument to pass to the procedure
+
+//   \param when is when (in simulated time) the interrupt is to occur
+
+//   \param type is the hardware device that generated the interrupt
+
+*/
+
+//----------------------------------------------------------------------
+
+void EventQueue::Insert(VoidFunctionPtr handler, int64_t arg, Time when,
+
+			IntType type) {
+
+  if (size == capacity) {
+
+    PendingInterrupt *larger = new PendingInterrupt[2 * capacity];
+
+    for (int i = 0; i < size; i++)
+
+      larger[i] = heap[i];
+
+    delete [] heap;
+
+    heap = larger;
+
+    capacity *= 2;
+
+  }
+
+  PendingInterrupt *event = &heap[size];
+
+  event->handler = handler;
+
+  event->arg = arg;
+
+  event->when = when;
+
+  event->type = type;
+
+  event->rank = nextRank++;
+
+  SiftUp(size++);
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// EventQueue::RemoveFirst
+
+/*!  Remove the first interrupt to occur from the queue.
+
+//
+
+//   \param event is where the removed interrupt is copied
+
+*/
+
+//----------------------------------------------------------------------
+
+void EventQueue::RemoveFirst(PendingInterrupt *event) {
+
+  ASSERT(size > 0);
+
+  *event = heap[0];
+
+  size--;
+
+  if (size > 0) {
+
+    heap[0] = heap[size];
+
+    SiftDown(0);
+
+  }
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// EventQueue::RotateFirst
+
+/*!  Put the first interrupt behind the other interrupts due at the
+
+//   same time, as if it was removed and scheduled again. Nothing has
+
+//   to be done when no other interrupt is due at the same time.
+
+*/
+
+//----------------------------------------------------------------------
+
+void EventQueue::RotateFirst() {
+
+  ASSERT(size > 0);
+
+  if (!FirstIsTied())
+
+    return;
+
+  heap[0].rank = nextRank++;
+
+  SiftDown(0);
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// CompareEvents
+
+/*!  Comparison function of two interrupts for qsort
+
+*/
+
+//----------------------------------------------------------------------
+
+static int CompareEvents(const void *a, const void *b) {
+
+  PendingInterrupt *ea = (PendingInterrupt *) a;
+
+  PendingInterrupt *eb = (PendingInterrupt *) b;
+
+  if (Before(ea, eb)) return -1;
+
+  if (Before(eb, ea)) return 1;
+
+  return 0;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// EventQueue::Mapcar
+
+/*!  Apply a function to all the pending interrupts, in the order they
+
+//   will occur (used for debugging).
+
+//
+
+//   \param func is the function to apply
+
+*/
+
+//----------------------------------------------------------------------
+
+void EventQueue::Mapcar(void (*func)(PendingInterrupt *)) {
+
+  PendingInterrupt *sorted = new PendingInterrupt[size > 0 ? size : 1];
+
+  for (int i = 0; i < size; i++)
+
+    sorted[i] = heap[i];
+
+  qsort(sorted, size, sizeof(PendingInterrupt), CompareEvents);
+
+  for (int i = 0; i < size; i++)
+
+    (*func)(&sorted[i]);
+
+  delete [] sorted;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// EventQueue::SiftUp
+
+/*!  Move an interrupt up the heap, until its parent occurs before it
+
+//
+
+//   \param i is the index of the interrupt in the heap array
+
+*/
+
+//----------------------------------------------------------------------
+
+void EventQueue::SiftUp(int i) {
+
+  PendingInterrupt event = heap[i];
+
+  while (i > 0) {
+
+    int parent = (i - 1) / 2;
+
+    if (!Before(&event, &heap[parent]))
+
+      break;
+
+    heap[i] = heap[parent];
+
+    i = parent;
+
+  }
+
+  heap[i] = event;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// EventQueue::SiftDown
+
+/*!  Move an interrupt down the heap, until it occurs before its
+
+//   children
+
+//
+
+//   \param i is the index of the interrupt in the heap array
+
+*/
+
+//----------------------------------------------------------------------
+
+void EventQueue::SiftDown(int i) {
+
+  PendingInterrupt event = heap[i];
+
+  for (;;) {
+
+    int child = 2 * i + 1;
+
+    if (child >= size)
+
+      break;
+
+    if ((child + 1 < size) && Before(&heap[child + 1], &heap[child]))
+
+      child++;
+
+    if (!Before(&heap[child], &event))
+
+      break;
+
+    heap[i] = heap[child];
+
+    i = child;
+
+  }
+
+  heap[i] = event;
+
+}
+
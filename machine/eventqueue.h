@@ -0,0 +1,144 @@
+/*! \file eventqueue.h
+
+   \brief Data structures for the queue of pending interrupts
+
+
+
+   The interrupts scheduled by the hardware device simulators are kept
+
+   in a binary min-heap, ordered by the time at which they are due.
+
+   Interrupts due at the same time are ordered by their insertion
+
+   rank, so that they are fired in the order they were scheduled, as
+
+   with a sorted list.
+
+
+
+   The interrupts are stored by value in the heap array, which is only
+
+   re-allocated when it grows: scheduling an interrupt does not
+
+   allocate memory.
+
+
+
+    DO NOT CHANGE -- part of the machine emulation
+
+
+
+    Copyright (c) 1999-2000 INSA de Rennes.
+
+    All rights reserved.
+
+    See copyright_insa.h for copyright notice and limitation
+
+    of liability and disclaimer of warranty provisions.
+
+*/
+
+
+
+#ifndef EVENTQUEUE_H
+
+#define EVENTQUEUE_H
+
+
+
+#include "machine/interrupt.h"
+
+
+
+/*! \brief Defines a priority queue of pending interrupts
+
+*/
+
+class EventQueue {
+
+public:
+
+  EventQueue();			//!< Initialize an empty queue
+
+  ~EventQueue();
+
+
+
+  void Insert(VoidFunctionPtr handler, int64_t arg, Time when, IntType type);
+
+  				//!< Schedule an interrupt, behind the
+
+				//!< interrupts due at the same time
+
+
+
+  bool IsEmpty() { return (size == 0); }
+
+  int Size() { return size; }
+
+
+
+  //! The first interrupt to occur (the queue must not be empty). The
+
+  //! pointer is only valid until the queue is modified.
+
+  PendingInterrupt *First() { return &heap[0]; }
+
+
+
+  //! true if another interrupt is due at the same time as the first one
+
+  bool FirstIsTied()
+
+    { return (((size > 1) && (heap[1].when == heap[0].when))
+
+	      || ((size > 2) && (heap[2].when == heap[0].when))); }
+
+
+
+  void RemoveFirst(PendingInterrupt *event);
+
+  				//!< Remove the first interrupt, and copy
+
+				//!< it to event
+
+
+
+  void RotateFirst();		//!< Put the first interrupt behind the
+
+				//!< other interrupts due at the same time
+
+
+
+  void Mapcar(void (*func)(PendingInterrupt *));
+
+  				//!< Apply func to all the interrupts, in
+
+				//!< the order they will occur
+
+
+
+private:
+
+  PendingInterrupt *heap;	//!< Heap array: heap[i] occurs before its
+
+				//!< children heap[2i+1] and heap[2i+2]
+
+  int size;			//!< Number of pending interrupts
+
+  int capacity;			//!< Size of the heap array
+
+  uint64_t nextRank;		//!< Insertion rank of the next interrupt
+
+
+
+  void SiftUp(int i);		//!< Restore the heap order, heap[i] having
+
+  void SiftDown(int i);		//!< moved up or down
+
+};
+
+
+
+#endif // EVENTQUEUE_H
+
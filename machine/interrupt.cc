@@ -44,6 +44,8 @@
 
 #include "machine/machine.h"
 
+#include "machine/eventqueue.h"
+
 #include "kernel/system.h"
 
 #include "kernel/thread.h"
@@ -100,6 +102,36 @@ PendingInterrupt::PendingInterrupt(VoidFunctionPtr func, int64_t param, Time t,
 
     type = kind;
 
+    rank = 0;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// PendingInterrupt::PendingInterrupt
+
+/*! 	Initialize an empty slot of the pending interrupt queue.
+
+*/
+
+//----------------------------------------------------------------------
+
+PendingInterrupt::PendingInterrupt()
+
+{
+
+    handler = NULL;
+
+    arg = 0;
+
+    when = 0;
+
+    type = TIMER_INT;
+
+    rank = 0;
+
 }
 
 
@@ -124,7 +156,7 @@ Interrupt::Interrupt()
 
     level = INTERRUPTS_OFF;
 
-    pending = new ListTime;
+    pending = new EventQueue;
 
     inHandler = false;
 
@@ -146,10 +178,6 @@ Interrupt::~Interrupt()
 
 {
 
-    while (!pending->IsEmpty())
-
-	delete (PendingInterrupt *)(pending->Remove());
-
     delete pending;
 
 }
@@ -328,6 +356,60 @@ Interrupt::OneTick(int nbcycles)
 
 
 
+//----------------------------------------------------------------------
+
+// Interrupt::NextEventTime
+
+/*! 	Return the simulated time at which the next pending interrupt
+
+//	is due. As long as the simulated time stays lower, OneTick only
+
+//	advances the time, so that a user instruction can be executed
+
+//	without calling it (see threaded.cc).
+
+//
+
+//	When several interrupts are due at the same time, CheckIfDue
+
+//	changes their order each time it finds the first one is not due
+
+//	yet. 0 is returned in this case, so that OneTick is called
+
+//	after each instruction and the order of handlers is preserved.
+
+//
+
+//  \return
+
+//	The time of the next interrupt, or the maximum time if there is
+
+//	no pending interrupt.
+
+*/
+
+//----------------------------------------------------------------------
+
+Time
+
+Interrupt::NextEventTime()
+
+{
+
+    if (pending->IsEmpty())
+
+	return (Time) -1;
+
+    if (pending->FirstIsTied())
+
+	return 0;
+
+    return pending->First()->when;
+
+}
+
+
+
 //----------------------------------------------------------------------
 
 // Interrupt::YieldOnReturn
@@ -480,7 +562,9 @@ Interrupt::Halt(int errorcode)
 
 //
 
-//	Implementation: just put it on a sorted list.
+//	Implementation: put it in a priority queue, ordered by time,
+
+//	behind the interrupts already scheduled at the same time.
 
 //
 
@@ -514,12 +598,6 @@ Interrupt::Schedule(VoidFunctionPtr handler, int64_t arg, int fromNow, IntType t
 
     when = g_stats->getTotalTicks() + fromNow;
 
-    PendingInterrupt *toOccur = new PendingInterrupt(handler, arg, when, type);
-
-
-
-    ASSERT(toOccur != NULL);
-
 
 
     DEBUG('i', (char *)"Scheduling interrupt handler %s at time = %llu\n", 
@@ -528,7 +606,7 @@ Interrupt::Schedule(VoidFunctionPtr handler, int64_t arg, int fromNow, IntType t
 
     ASSERT(fromNow > 0);
 
-    pending->SortedInsert(toOccur, when);
+    pending->Insert(handler, arg, when, type);
 
 }
 
@@ -570,6 +648,8 @@ Interrupt::CheckIfDue(bool advanceClock)
 
   MachineStatus old = g_machine->GetStatus();
 
+  PendingInterrupt toOccur;
+
   Time when;
 
 
@@ -582,13 +662,7 @@ Interrupt::CheckIfDue(bool advanceClock)
 
     DumpState();
 
-  PendingInterrupt *toOccur = 
-
-    (PendingInterrupt *)pending->SortedRemove(&when);
-
-  
-
-  if (toOccur == NULL)		// no pending interrupts
+  if (pending->IsEmpty())		// no pending interrupts
 
     {
 
@@ -596,6 +670,8 @@ Interrupt::CheckIfDue(bool advanceClock)
 
     }
 
+  when = pending->First()->when;
+
   
 
   if (advanceClock && when > g_stats->getTotalTicks()) { // advance the clock
@@ -606,9 +682,9 @@ Interrupt::CheckIfDue(bool advanceClock)
 
     //	delete when;
 
-  } else if (when > g_stats->getTotalTicks()) {	// not time yet, put it back
+  } else if (when > g_stats->getTotalTicks()) {	// not time yet, put it
 
-    pending->SortedInsert(toOccur, when);
+    pending->RotateFirst();			// behind its ties
 
     return false;
 
@@ -618,11 +694,9 @@ Interrupt::CheckIfDue(bool advanceClock)
 
   // Check if there is nothing more to do, and if so, quit
 
-  if ((g_machine->GetStatus() == IDLE_MODE) && (toOccur->type == TIMER_INT) 
-
-				&& pending->IsEmpty()) {
+  if ((g_machine->GetStatus() == IDLE_MODE) && (pending->First()->type == TIMER_INT) 
 
-	 pending->SortedInsert(toOccur, when);
+				&& (pending->Size() == 1)) {
 
 	 printf("this is the end \n");
 
@@ -638,6 +712,10 @@ Interrupt::CheckIfDue(bool advanceClock)
 
 
 
+    pending->RemoveFirst(&toOccur);		// the handler may schedule
+
+    						// new interrupts
+
     inHandler = true;
 
     g_machine->SetStatus(SYSTEM_MODE);		// whatever we were doing,
@@ -646,14 +724,12 @@ Interrupt::CheckIfDue(bool advanceClock)
 
 						// running in the kernel
 
-    (*(toOccur->handler))(toOccur->arg);	// call the interrupt handler
+    (*(toOccur.handler))(toOccur.arg);	// call the interrupt handler
 
     g_machine->SetStatus(old);			// restore the machine status
 
     inHandler = false;
 
-    delete toOccur;
-
     return true;
 
 }
@@ -676,14 +752,10 @@ Interrupt::CheckIfDue(bool advanceClock)
 
 static void
 
-PrintPending(int64_t arg)
+PrintPending(PendingInterrupt *pend)
 
 {
 
-    PendingInterrupt *pend = (PendingInterrupt *)arg;
-
-
-
     printf("Interrupt handler %s, scheduled at time %llu\n", 
 
 	   intTypeNames[pend->type], pend->when);
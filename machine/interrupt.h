@@ -80,6 +80,10 @@
 
 
 
+class EventQueue;
+
+
+
 //! Interrupts can be disabled (INT_OFF) or enabled (INT_ON)
 
 enum IntStatus {INTERRUPTS_OFF, INTERRUPTS_ON};
@@ -122,6 +126,10 @@ class PendingInterrupt {
 
 				// occur in the future
 
+    PendingInterrupt();		// Initialize an empty slot of the
+
+				// pending interrupt queue
+
 
 
     VoidFunctionPtr handler;    /*!< The function (in the hardware device
@@ -136,6 +144,10 @@ class PendingInterrupt {
 
     IntType type;		//!< for debugging
 
+    uint64_t rank;		//!< Insertion rank, orders the interrupts
+
+				//!< due at the same time
+
 };
 
 
@@ -222,11 +234,17 @@ public:
 
 
 
+  Time NextEventTime();		//!< Time before which OneTick has nothing
+
+				//!< to do but advancing the simulated time
+
+
+
 private:
 
   IntStatus level;		//!< are interrupts enabled or disabled?
 
-  ListTime *pending;		/*!< the list of interrupts scheduled
+  EventQueue *pending;		/*!< the queue of interrupts scheduled
 
 				  to occur in the future
 
@@ -18,6 +18,8 @@
 
 #include "kernel/system.h"
 
+#include "kernel/thread.h"
+
 #include "machine/interrupt.h"
 
 #include "machine/machine.h"
@@ -40,9 +42,9 @@ static char* exceptionNames[] = { (char*)"no exception", (char*)"syscall",
 
 				(char*)"bus error", (char*)"address error", (char*)"overflow",
 
-				(char*)"illegal instruction" };
+				(char*)"illegal instruction", (char*)"coprocessor unusable" };
 
-#define EXCEPTION_NUMBER 7 //!< Size of exceptionNames, used for sanity checks
+#define EXCEPTION_NUMBER 8 //!< Size of exceptionNames, used for sanity checks
 
 
 
@@ -186,6 +188,8 @@ Machine::Machine(bool debug)
 
       float_registers[i] = 0;
 
+    fpuEnabled = false;
+
 
 
     // Allocate the main memory of the machine and fills it up with zeroes
@@ -198,6 +202,8 @@ Machine::Machine(bool debug)
 
       mainMemory[i] = 0;
 
+    decodeCache = new DecodeCache(g_cfg->NumPhysPages, g_cfg->PageSize);
+
 
 
     // Check the endianess of the host machine
@@ -232,6 +238,10 @@ Machine::Machine(bool debug)
 
     status = SYSTEM_MODE;
 
+    pendingTicks = 0;
+
+    deadline = 0;
+
 
 
 }
@@ -256,6 +266,8 @@ Machine::~Machine()
 
   delete [] mainMemory;
 
+  delete decodeCache;
+
 
 
   // Deallocate the machine components
@@ -310,6 +322,24 @@ Machine::RaiseException(ExceptionType which, int badVAddr)
 
  
 
+    // Charge the execution time of the previous instructions, not
+
+    // charged yet by Machine::Run, before entering the kernel
+
+    if (pendingTicks != 0) {
+
+      g_current_thread->GetProcessOwner()->stat->incrUserTicks(pendingTicks);
+
+      pendingTicks = 0;
+
+    }
+
+    // The kernel may schedule new interrupts: stop the current batch
+
+    deadline = 0;
+
+
+
     // Call of the exception handler
 
     int_registers[BADVADDR_REG] = badVAddr;
@@ -524,6 +554,56 @@ Machine::DumpState()
 
 
 
+//----------------------------------------------------------------------
+
+// Machine::StateChecksum
+
+/*! 	Compute a checksum of the parts of the machine state that are
+
+//	not printed by DumpState: the main memory, the floating point
+
+//	registers and the condition code. Used to compare the final
+
+//	state reached by the two execution engines.
+
+//
+
+//	\return the checksum (32 bits FNV-1a hash)
+
+*/
+
+//----------------------------------------------------------------------
+
+uint32_t
+
+Machine::StateChecksum()
+
+{
+
+    uint32_t hash = 2166136261U;
+
+    int memSize = g_cfg->NumPhysPages * g_cfg->PageSize;
+
+    int i;
+
+
+
+    for (i = 0; i < memSize; i++)
+
+      hash = (hash ^ (uint8_t) mainMemory[i]) * 16777619U;
+
+    for (i = 0; i < NUM_FP_REGS; i++)
+
+      hash = (hash ^ (uint32_t) float_registers[i]) * 16777619U;
+
+    hash = (hash ^ (uint8_t) cc) * 16777619U;
+
+    return hash;
+
+}
+
+
+
 //----------------------------------------------------------------------
 
 // Machine::ReadRegister/WriteRegister
@@ -88,6 +88,12 @@ enum ExceptionType { NO_EXCEPTION,           //!< Everything ok!
 
 		     ILLEGALINSTR_EXCEPTION, //!< Unimplemented or reserved instr.
 
+		     COPROCUNUSABLE_EXCEPTION, /*!< Floating point instruction
+
+					     while the FPU is disabled
+
+					     (see fpuEnabled) */
+
 		     
 
 		     NUM_EXCEPTION_TYPES
@@ -104,6 +110,8 @@ enum ExceptionType { NO_EXCEPTION,           //!< Everything ok!
 
 #include "machine/interrupt.h"
 
+#include "machine/decodecache.h"
+
 class Console;
 
 
@@ -302,6 +310,22 @@ class Machine {
 
                                 //!< Return the execution time of the instr (cycle)
 
+    bool ExecuteInstruction(Instruction *instr);
+
+    				//!< Execute a decoded instruction. Return
+
+				//!< false if an exception was raised
+
+    void RunThreaded();		//!< Run a user program with the threaded
+
+				//!< engine (see threaded.cc)
+
+    bool RunBlock();		//!< Execute one basic block of threaded code
+
+    Time NextDeadline();	//!< Time until which instructions can be
+
+				//!< executed without checking interrupts
+
     void DelayedLoad(int nextReg, int nextVal);  	
 
 				//!< Do a pending delayed load (modifying a reg)
@@ -320,6 +344,10 @@ class Machine {
 
     void DumpState();		//!< Print the user CPU and memory state 
 
+    uint32_t StateChecksum();	//!< Checksum of the main memory and of the
+
+				//!< floating point registers
+
 
 
 
@@ -350,6 +378,16 @@ class Machine {
 
 
 
+  bool fpuEnabled;               /*!< false if the floating point registers
+
+				   and cc hold the state of another thread:
+
+				   the next floating point instruction
+
+				   raises a COPROCUNUSABLE_EXCEPTION */
+
+
+
   int8_t *mainMemory;		/*!< Physical memory to store user program,
 
 				  code and data, while executing
@@ -358,6 +396,12 @@ class Machine {
 
 
 
+  DecodeCache *decodeCache;     /*!< Decoded instructions, per physical
+
+				  page of mainMemory */
+
+
+
   MMU *mmu;                     /*!< Machine memory management unit */
 
   ACIA *acia;                   /*!< ACIA Hardware */
@@ -378,6 +422,26 @@ private:
 
 
 
+  Time pendingTicks;		/*!< Execution time of the user instructions
+
+				  executed since the last call to
+
+				  Interrupt::OneTick, not charged yet
+
+				*/
+
+  Time deadline;		/*!< Simulated time until which user
+
+				  instructions are executed without calling
+
+				  Interrupt::OneTick. Reset by RaiseException,
+
+				  since the kernel may schedule interrupts
+
+				*/
+
+
+
   bool singleStep;		/*!< Drop back into the debugger after each
 
 				  simulated instruction
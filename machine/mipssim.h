@@ -338,6 +338,12 @@
 
 
 
+/* Floating point instructions are numbered from OP_LWC1 to OP_CTC1 */
+
+#define IsFPOpcode(op)	(((op) >= OP_LWC1) && ((op) <= OP_CTC1))
+
+
+
 /*
 
  * Miscellaneous definitions:
@@ -404,41 +410,7 @@ struct OpInfo {
 
  */
 
-static OpInfo opTable[] = {
-
-    {SPECIAL, RFMT}, {BCOND, IFMT}, {OP_J, JFMT}, {OP_JAL, JFMT},
-
-    {OP_BEQ, IFMT}, {OP_BNE, IFMT}, {OP_BLEZ, IFMT}, {OP_BGTZ, IFMT},
-
-    {OP_ADDI, IFMT}, {OP_ADDIU, IFMT}, {OP_SLTI, IFMT}, {OP_SLTIU, IFMT},
-
-    {OP_ANDI, IFMT}, {OP_ORI, IFMT}, {OP_XORI, IFMT}, {OP_LUI, IFMT},
-
-    {OP_UNIMP, IFMT}, {COP1, IFMT}, {OP_UNIMP, IFMT}, {OP_UNIMP, IFMT},
-
-    {OP_RES, IFMT}, {OP_RES, IFMT}, {OP_RES, IFMT}, {OP_RES, IFMT},
-
-    {OP_RES, IFMT}, {OP_RES, IFMT}, {OP_RES, IFMT}, {OP_RES, IFMT},
-
-    {OP_RES, IFMT}, {OP_RES, IFMT}, {OP_RES, IFMT}, {OP_RES, IFMT},
-
-    {OP_LB, IFMT}, {OP_LH, IFMT}, {OP_LWL, IFMT}, {OP_LW, IFMT},
-
-    {OP_LBU, IFMT}, {OP_LHU, IFMT}, {OP_LWR, IFMT}, {OP_RES, IFMT},
-
-    {OP_SB, IFMT}, {OP_SH, IFMT}, {OP_SWL, IFMT}, {OP_SW, IFMT},
-
-    {OP_RES, IFMT}, {OP_RES, IFMT}, {OP_SWR, IFMT}, {OP_RES, IFMT},
-
-    {OP_UNIMP, IFMT}, {OP_LWC1, IFMT}, {OP_UNIMP, IFMT}, {OP_UNIMP, IFMT},
-
-    {OP_RES, IFMT}, {OP_LDC1, IFMT}, {OP_RES, IFMT}, {OP_RES, IFMT},
-
-    {OP_UNIMP, IFMT}, {OP_SWC1, IFMT}, {OP_UNIMP, IFMT}, {OP_UNIMP, IFMT},
-
-    {OP_RES, IFMT}, {OP_SDC1, IFMT}, {OP_RES, IFMT}, {OP_RES, IFMT}
-
-};
+extern OpInfo opTable[];
 
 
 
@@ -452,25 +424,7 @@ static OpInfo opTable[] = {
 
 
 
-static int specialTable[] = {
-
-    OP_SLL, OP_RES, OP_SRL, OP_SRA, OP_SLLV, OP_RES, OP_SRLV, OP_SRAV,
-
-    OP_JR, OP_JALR, OP_RES, OP_RES, OP_SYSCALL, OP_UNIMP, OP_RES, OP_RES,
-
-    OP_MFHI, OP_MTHI, OP_MFLO, OP_MTLO, OP_RES, OP_RES, OP_RES, OP_RES,
-
-    OP_MULT, OP_MULTU, OP_DIV, OP_DIVU, OP_RES, OP_RES, OP_RES, OP_RES,
-
-    OP_ADD, OP_ADDU, OP_SUB, OP_SUBU, OP_AND, OP_OR, OP_XOR, OP_NOR,
-
-    OP_RES, OP_RES, OP_SLT, OP_SLTU, OP_RES, OP_RES, OP_RES, OP_RES,
-
-    OP_RES, OP_RES, OP_RES, OP_RES, OP_RES, OP_RES, OP_RES, OP_RES,
-
-    OP_RES, OP_RES, OP_RES, OP_RES, OP_RES, OP_RES, OP_RES, OP_RES
-
-};
+extern int specialTable[];
 
 
 
@@ -488,41 +442,7 @@ static int specialTable[] = {
 
 
 
-static int cop1STable [] = {
-
-    OP_ADD_S, OP_SUB_S, OP_MUL_S, OP_DIV_S, 
-
-    OP_SQRT_S, OP_ABS_S, OP_MOV_S, OP_NEG_S,
-
-    OP_RES, OP_RES, OP_RES, OP_RES, 
-
-    OP_ROUND_W_S, OP_TRUNC_W_S, OP_CEIL_W_S, OP_FLOOR_W_S,
-
-    OP_RES, OP_UNIMP, OP_UNIMP, OP_UNIMP, 
-
-    OP_RES, OP_RES, OP_RES, OP_RES, 
-
-    OP_RES, OP_RES, OP_RES, OP_RES, 
-
-    OP_RES, OP_RES, OP_RES, OP_RES,
-
-    OP_RES, OP_CVT_D_S, OP_RES, OP_RES, 
-
-    OP_CVT_W_S, OP_RES, OP_RES, OP_RES,
-
-    OP_RES, OP_RES, OP_RES, OP_RES, 
-
-    OP_RES, OP_RES, OP_RES, OP_RES,
-
-    OP_C_F_S, OP_C_UN_S, OP_C_EQ_S, OP_C_UEQ_S,
-
-    OP_C_OLT_S,  OP_C_ULT_S, OP_C_OLE_S,  OP_C_ULE_S,
-
-    OP_C_SF_S, OP_C_NGLE_S, OP_C_SEQ_S, OP_C_NGL_S,
-
-    OP_C_LT_S, OP_C_NGE_S, OP_C_LE_S, OP_C_NGT_S
-
-};
+extern int cop1STable[];
 
 
 
@@ -538,41 +458,7 @@ static int cop1STable [] = {
 
 
 
-static int cop1DTable [] = {
-
-    OP_ADD_D, OP_SUB_D, OP_MUL_D, OP_DIV_D, 
-
-    OP_SQRT_D, OP_ABS_D, OP_MOV_D, OP_NEG_D,
-
-    OP_RES, OP_RES, OP_RES, OP_RES, 
-
-    OP_ROUND_W_D, OP_TRUNC_W_D, OP_CEIL_W_D, OP_FLOOR_W_D,
-
-    OP_RES, OP_UNIMP, OP_UNIMP, OP_UNIMP, 
-
-    OP_RES, OP_RES, OP_RES, OP_RES, 
-
-    OP_RES, OP_RES, OP_RES, OP_RES, 
-
-    OP_RES, OP_RES, OP_RES, OP_RES,
-
-    OP_CVT_S_D, OP_RES, OP_RES, OP_RES, 
-
-    OP_CVT_W_D, OP_RES, OP_RES, OP_RES,
-
-    OP_RES, OP_RES, OP_RES, OP_RES, 
-
-    OP_RES, OP_RES, OP_RES, OP_RES,
-
-    OP_C_F_D, OP_C_UN_D, OP_C_EQ_D, OP_C_UEQ_D,
-
-    OP_C_OLT_D, OP_C_ULT_D, OP_C_OLE_D, OP_C_ULE_D,
-
-    OP_C_SF_D, OP_C_NGLE_D, OP_C_SEQ_D, OP_C_NGL_D,
-
-    OP_C_LT_D, OP_C_NGE_D, OP_C_LE_D, OP_C_NGT_D
-
-};
+extern int cop1DTable[];
 
 
 
@@ -596,289 +482,7 @@ struct OpString {
 
 //! Textual form of instructions
 
-static struct OpString opStrings[] = {
-
-	{(char*)"Shouldn't happen", {NONE, NONE, NONE}},
-
-	{(char*)"ADD r%d,r%d,r%d", {RD, RS, RT}},
-
-	{(char*)"ADDI r%d,r%d,%d", {RT, RS, EXTRA}},
-
-	{(char*)"ADDIU r%d,r%d,%d", {RT, RS, EXTRA}},
-
-	{(char*)"ADDU r%d,r%d,r%d", {RD, RS, RT}},
-
-	{(char*)"AND r%d,r%d,r%d", {RD, RS, RT}},
-
-	{(char*)"ANDI r%d,r%d,%d", {RT, RS, EXTRA}},
-
-	{(char*)"BEQ r%d,r%d,%d", {RS, RT, EXTRA}},
-
-	{(char*)"BGEZ r%d,%d", {RS, EXTRA, NONE}},
-
-	{(char*)"BGEZAL r%d,%d", {RS, EXTRA, NONE}},
-
-	{(char*)"BGTZ r%d,%d", {RS, EXTRA, NONE}},
-
-	{(char*)"BLEZ r%d,%d", {RS, EXTRA, NONE}},
-
-	{(char*)"BLTZ r%d,%d", {RS, EXTRA, NONE}},
-
-	{(char*)"BLTZAL r%d,%d", {RS, EXTRA, NONE}},
-
-	{(char*)"BNE r%d,r%d,%d", {RS, RT, EXTRA}},
-
-	{(char*)"Shouldn't happen", {NONE, NONE, NONE}},
-
-	{(char*)"DIV r%d,r%d", {RS, RT, NONE}},
-
-	{(char*)"DIVU r%d,r%d", {RS, RT, NONE}},
-
-	{(char*)"J 0x%x", {EXTRA, NONE, NONE}},
-
-	{(char*)"JAL 0x%x", {EXTRA, NONE, NONE}},
-
-	{(char*)"JALR r%d,r%d", {RD, RS, NONE}},
-
-	{(char*)"JR r%d,r%d", {RD, RS, NONE}},
-
-	{(char*)"LB r%d,%d(r%d)", {RT, EXTRA, RS}},
-
-	{(char*)"LBU r%d,%d(r%d)", {RT, EXTRA, RS}},
-
-	{(char*)"LH r%d,%d(r%d)", {RT, EXTRA, RS}},
-
-	{(char*)"LHU r%d,%d(r%d)", {RT, EXTRA, RS}},
-
-	{(char*)"LUI r%d,%d", {RT, EXTRA, NONE}},
-
-	{(char*)"LW r%d,%d(r%d)", {RT, EXTRA, RS}},
-
-	{(char*)"LWL r%d,%d(r%d)", {RT, EXTRA, RS}},
-
-	{(char*)"LWR r%d,%d(r%d)", {RT, EXTRA, RS}},
-
-	{(char*)"Shouldn't happen", {NONE, NONE, NONE}},
-
-	{(char*)"MFHI r%d", {RD, NONE, NONE}},
-
-	{(char*)"MFLO r%d", {RD, NONE, NONE}},
-
-	{(char*)"Shouldn't happen", {NONE, NONE, NONE}},
-
-	{(char*)"MTHI r%d", {RS, NONE, NONE}},
-
-	{(char*)"MTLO r%d", {RS, NONE, NONE}},
-
-	{(char*)"MULT r%d,r%d", {RS, RT, NONE}},
-
-	{(char*)"MULTU r%d,r%d", {RS, RT, NONE}},
-
-	{(char*)"NOR r%d,r%d,r%d", {RD, RS, RT}},
-
-	{(char*)"OR r%d,r%d,r%d", {RD, RS, RT}},
-
-	{(char*)"ORI r%d,r%d,%d", {RT, RS, EXTRA}},
-
-	{(char*)"RFE", {NONE, NONE, NONE}},
-
-	{(char*)"SB r%d,%d(r%d)", {RT, EXTRA, RS}},
-
-	{(char*)"SH r%d,%d(r%d)", {RT, EXTRA, RS}},
-
-	{(char*)"SLL r%d,r%d,%d", {RD, RT, EXTRA}},
-
-	{(char*)"SLLV r%d,r%d,r%d", {RD, RT, RS}},
-
-	{(char*)"SLT r%d,r%d,r%d", {RD, RS, RT}},
-
-	{(char*)"SLTI r%d,r%d,%d", {RT, RS, EXTRA}},
-
-	{(char*)"SLTIU r%d,r%d,%d", {RT, RS, EXTRA}},
-
-	{(char*)"SLTU r%d,r%d,r%d", {RD, RS, RT}},
-
-	{(char*)"SRA r%d,r%d,%d", {RD, RT, EXTRA}},
-
-	{(char*)"SRAV r%d,r%d,r%d", {RD, RT, RS}},
-
-	{(char*)"SRL r%d,r%d,%d", {RD, RT, EXTRA}},
-
-	{(char*)"SRLV r%d,r%d,r%d", {RD, RT, RS}},
-
-	{(char*)"SUB r%d,r%d,r%d", {RD, RS, RT}},
-
-	{(char*)"SUBU r%d,r%d,r%d", {RD, RS, RT}},
-
-	{(char*)"SW r%d,%d(r%d)", {RT, EXTRA, RS}},
-
-	{(char*)"SWL r%d,%d(r%d)", {RT, EXTRA, RS}},
-
-	{(char*)"SWR r%d,%d(r%d)", {RT, EXTRA, RS}},
-
-	{(char*)"XOR r%d,r%d,r%d", {RD, RS, RT}},
-
-	{(char*)"XORI r%d,r%d,%d", {RT, RS, EXTRA}},
-
-	{(char*)"SYSCALL", {NONE, NONE, NONE}},
-
-
-
-	/* Some of the floating point instructions (MIPS I, no "W" instr) */
-
-	{(char*)"LWC1 f%d,%d(r%d)", {FT, EXTRA, RS}},
-
-	{(char*)"LDC1 f%d,%d(r%d)", {FT, EXTRA, RS}},
-
-	{(char*)"SWC1 f%d,%d(r%d)", {FT, EXTRA, RS}},
-
-	{(char*)"SDC1 f%d,%d(r%d)", {FT, EXTRA, RS}},
-
-	{(char*)"ABS.S f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"ABS.D f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"ADD.S f%d,f%d,f%d", {FD, FS, FT}},
-
-	{(char*)"ADD.D f%d,f%d,f%d", {FD, FS, FT}},
-
-	{(char*)"DIV.S f%d,f%d,f%d", {FD, FS, FT}},
-
-	{(char*)"DIV.D f%d,f%d,f%d", {FD, FS, FT}},
-
-	{(char*)"MUL.S f%d,f%d,f%d", {FD, FS, FT}},
-
-	{(char*)"MUL.D f%d,f%d,f%d", {FD, FS, FT}},
-
-	{(char*)"NEG.S f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"NEG.D f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"SUB.S f%d,f%d,f%d", {FD, FS, FT}},
-
-	{(char*)"SUB.D f%d,f%d,f%d", {FD, FS, FT}},
-
-	{(char*)"CVT.S.D f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"CVT.S.W f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"CVT.W.S f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"CVT.W.D f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"CVT.D.S f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"CVT.D.W f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"CEIL.W.S f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"CEIL.W.D f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"FLOOR.W.S f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"FLOOR.W.D f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"ROUND.W.S f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"ROUND.W.D f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"TRUNC.W.S f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"TRUNC.W.D f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"MOV.S f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"MOV.D f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"BC1F %d", {EXTRA, NONE, NONE}},
-
-	{(char*)"BC1T %d", {EXTRA, NONE, NONE}},
-
-	{(char*)"BC1FL %d", {EXTRA, NONE, NONE}},
-
-	{(char*)"BC1TL %d", {EXTRA, NONE, NONE}},
-
-	{(char*)"SQRT.S f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"SQRT.D f%d,f%d", {FD, FS, NONE}},
-
-	{(char*)"C.F.S f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.UN.S f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.EQ.S f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.UEQ.S f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.OLT.S f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.ULT.S f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.OLE.S f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.ULE.S f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.SF.S f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.NGLE.S f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.SEQ.S f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.NGL.S f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.LT.S f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.NGE.S f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.LE.S f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.NGT.S f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.F.D f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.UN.D f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.EQ.D f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.UEQ.D f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.OLT.D f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.ULT.D f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.OLE.D f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.ULE.D f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.SF.D f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.NGLE.D f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.SEQ.D f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.NGL.D f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.LT.D f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.NGE.D f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.LE.D f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"C.NGT.D f%d,f%d", {FS, FT, NONE}},
-
-	{(char*)"OP_MFC1 r%d,f%d", {RT, FS, NONE}},
-
-        {(char*)"OP_CFC1 r%d,f%d", {RT, FS, NONE}},
-
-	{(char*)"OP_MTC1 r%d,f%d", {RT, FS, NONE}},
-
-        {(char*)"OP_CTC1 r%d,f%d", {RT, FS, NONE}},
-
-	{(char*)"Unimplemented", {NONE, NONE, NONE}},
-
-	{(char*)"Reserved", {NONE, NONE, NONE}}
-
-      };
+extern struct OpString opStrings[];
 
 
 
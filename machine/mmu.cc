@@ -20,11 +20,13 @@
 
 //
 
-// NB: one could also use a TLB in replacement or addition of
+// The translations are cached in a software TLB (see mmu.h),
 
-// the linear page table (not integrated in the current version
+// configured by TLBSize and TLBAssociativity in the configuration
 
-// of the source code).
+// file. The page table remains the reference: the TLB only saves
+
+// the page table lookups of the pages recently translated.
 
 //
 
@@ -42,6 +44,10 @@
 
 
 
+#include <string.h>
+
+
+
 #include "machine/machine.h"
 
 #include "kernel/system.h"
@@ -58,7 +64,7 @@
 
 // MMU::MMU()
 
-/*! Construction. Empty for now  
+/*! Construction. Allocate the TLB, initially empty
 
 */
 
@@ -68,6 +74,36 @@ MMU::MMU() {
 
   translationTable = NULL;
 
+  pageShift = 0;
+
+  while ((1 << pageShift) < g_cfg->PageSize) pageShift++;
+
+  tlb = NULL;
+
+  tlbVictim = NULL;
+
+  tlbWays = g_cfg->TLBAssociativity;
+
+  tlbSets = g_cfg->TLBSize / tlbWays;
+
+  if (tlbSets > 0) {
+
+    tlb = new TLBEntry[tlbSets * tlbWays];
+
+    for (int i = 0; i < tlbSets * tlbWays; i++)
+
+      tlb[i].valid = false;
+
+    tlbVictim = new int[tlbSets];
+
+    for (int i = 0; i < tlbSets; i++)
+
+      tlbVictim[i] = 0;
+
+  }
+
+  tlbHits = tlbMisses = 0;
+
 }
 
 
@@ -76,7 +112,7 @@ MMU::MMU() {
 
 // MMU::~MMU()
 
-/*! Destructor. Empty for now
+/*! Destructor. De-allocate the TLB
 
 */
 
@@ -86,6 +122,10 @@ MMU::~MMU() {
 
   translationTable = NULL;
 
+  delete [] tlb;
+
+  delete [] tlbVictim;
+
 }
 
 
@@ -214,6 +254,122 @@ MMU::ReadMem(uint32_t virtAddr, int size, uint32_t *value, bool is_instruction)
 
 
 
+//----------------------------------------------------------------------
+
+// MMU::FetchInstruction
+
+/*!     Fetch the instruction stored at virtual address "addr", in its
+
+//	decoded form. Address translation and statistics are the same
+
+//	as for a 4 bytes ReadMem, but the decoding is only done the
+
+//	first time the instruction is executed (see decodecache.h).
+
+//
+
+//	\param addr the virtual address of the instruction
+
+//      \return the decoded instruction, or NULL if the translation
+
+//              step from virtual to physical memory failed.
+
+*/
+
+//----------------------------------------------------------------------
+
+Instruction *
+
+MMU::FetchInstruction(uint32_t virtAddr)
+
+{
+
+  uint32_t physAddr;
+
+
+
+    if (!TranslateFetch(virtAddr, &physAddr))
+
+      return NULL;
+
+    return g_machine->decodeCache->Fetch(physAddr);
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// MMU::TranslateFetch
+
+/*!     Translate the address of an instruction to be fetched, with the
+
+//	same statistics as a 4 bytes ReadMem. Raise an exception if
+
+//	the translation fails.
+
+//
+
+//	\param addr the virtual address of the instruction
+
+//	\param physAddr pointer to the place to store the physical address
+
+//      \return false if the translation step from virtual to physical
+
+//              memory failed, true otherwise.
+
+*/
+
+//----------------------------------------------------------------------
+
+bool
+
+MMU::TranslateFetch(uint32_t virtAddr, uint32_t *physAddr)
+
+{
+
+  ExceptionType exc;
+
+  uint32_t physAddrEnd;
+
+
+
+    DEBUG('h', (char *)"Fetching instruction at VA 0x%x\n", virtAddr);
+
+
+
+    // Update statistics
+
+    g_current_thread->GetProcessOwner()->stat->incrMemoryAccess();
+
+
+
+    // Perform address translation
+
+    exc = Translate(virtAddr, physAddr, 4, false);
+
+    Translate(virtAddr, &physAddrEnd, 4, false);
+
+    if (exc==NO_EXCEPTION) ASSERT(*physAddr==physAddrEnd);
+
+
+
+    // Raise an exception if one has been detected during address translation
+
+    if (exc != NO_EXCEPTION) {
+
+	g_machine->RaiseException(exc, virtAddr);
+
+	return false;
+
+    }
+
+    return true;
+
+}
+
+
+
 //----------------------------------------------------------------------
 
 // MMU::WriteMem
@@ -284,6 +440,12 @@ MMU::WriteMem(uint32_t addr, int size, uint32_t value)
 
 
 
+    // Decoded instructions of this page are no longer valid
+
+    g_machine->decodeCache->NotifyWrite(physicalAddress);
+
+
+
     // Write into the machine main memory
 
     switch (size) {
@@ -328,6 +490,254 @@ MMU::WriteMem(uint32_t addr, int size, uint32_t value)
 
 
 
+//----------------------------------------------------------------------
+
+// MMU::ReadMemBlock
+
+/*!     Copy "size" bytes of virtual memory at "addr" to a kernel
+
+//	buffer. The range is translated once per page, and each page is
+
+//	copied at once: each page accessed counts as one memory access.
+
+//	Page faults are handled by the translation, as for ReadMem.
+
+//
+
+//	\param addr the virtual address to read from
+
+//	\param dest the kernel buffer
+
+//	\param size the number of bytes to read
+
+//      \return the number of bytes copied, less than size if the
+
+//              translation of a page failed (the exception is raised)
+
+*/
+
+//----------------------------------------------------------------------
+
+int
+
+MMU::ReadMemBlock(uint32_t virtAddr, char *dest, int size)
+
+{
+
+  int done = 0;
+
+  int chunk;
+
+  uint32_t physAddr;
+
+  ExceptionType exc;
+
+
+
+    DEBUG('h', (char *)"Reading block at VA 0x%x, size %d\n", virtAddr, size);
+
+    while (done < size) {
+
+      // Copy up to the end of the page
+
+      chunk = g_cfg->PageSize - (virtAddr % g_cfg->PageSize);
+
+      if (chunk > size - done) chunk = size - done;
+
+      exc = Translate(virtAddr, &physAddr, 1, false);
+
+      if (exc != NO_EXCEPTION) {
+
+	g_machine->RaiseException(exc, virtAddr);
+
+	return done;
+
+      }
+
+      memcpy(dest + done, &g_machine->mainMemory[physAddr], chunk);
+
+      done += chunk;
+
+      virtAddr += chunk;
+
+    }
+
+    return done;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// MMU::WriteMemBlock
+
+/*!     Copy "size" bytes of a kernel buffer to virtual memory at
+
+//	"addr", one page at a time (see ReadMemBlock).
+
+//
+
+//	\param addr the virtual address to write to
+
+//	\param src the kernel buffer
+
+//	\param size the number of bytes to write
+
+//      \return the number of bytes copied, less than size if the
+
+//              translation of a page failed (the exception is raised)
+
+*/
+
+//----------------------------------------------------------------------
+
+int
+
+MMU::WriteMemBlock(uint32_t virtAddr, const char *src, int size)
+
+{
+
+  int done = 0;
+
+  int chunk;
+
+  uint32_t physAddr;
+
+  ExceptionType exc;
+
+
+
+    DEBUG('h', (char *)"Writing block at VA 0x%x, size %d\n", virtAddr, size);
+
+    while (done < size) {
+
+      // Copy up to the end of the page
+
+      chunk = g_cfg->PageSize - (virtAddr % g_cfg->PageSize);
+
+      if (chunk > size - done) chunk = size - done;
+
+      exc = Translate(virtAddr, &physAddr, 1, true);
+
+      if (exc != NO_EXCEPTION) {
+
+	g_machine->RaiseException(exc, virtAddr);
+
+	return done;
+
+      }
+
+      // Decoded instructions of this page are no longer valid
+
+      g_machine->decodeCache->NotifyWrite(physAddr);
+
+      memcpy(&g_machine->mainMemory[physAddr], src + done, chunk);
+
+      done += chunk;
+
+      virtAddr += chunk;
+
+    }
+
+    return done;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// MMU::ReadMemString
+
+/*!     Copy a '\0' terminated string of virtual memory at "addr" to a
+
+//	kernel buffer, one page at a time (see ReadMemBlock). At most
+
+//	maxlen bytes are read, and dest is always '\0' terminated.
+
+//
+
+//	\param addr the virtual address of the string
+
+//	\param dest the kernel buffer, or NULL to only get the length
+
+//	       of the string
+
+//	\param maxlen the size of the kernel buffer
+
+//      \return the number of bytes read, including the trailing '\0'
+
+//              if it was found
+
+*/
+
+//----------------------------------------------------------------------
+
+int
+
+MMU::ReadMemString(uint32_t virtAddr, char *dest, int maxlen)
+
+{
+
+  int done = 0;
+
+  int chunk;
+
+  uint32_t physAddr;
+
+  ExceptionType exc;
+
+  char *src, *end = NULL;
+
+
+
+    DEBUG('h', (char *)"Reading string at VA 0x%x\n", virtAddr);
+
+    while ((done < maxlen) && (end == NULL)) {
+
+      // Look for the end of the string up to the end of the page
+
+      chunk = g_cfg->PageSize - (virtAddr % g_cfg->PageSize);
+
+      if (chunk > maxlen - done) chunk = maxlen - done;
+
+      exc = Translate(virtAddr, &physAddr, 1, false);
+
+      if (exc != NO_EXCEPTION) {
+
+	g_machine->RaiseException(exc, virtAddr);
+
+	break;
+
+      }
+
+      src = (char *) &g_machine->mainMemory[physAddr];
+
+      end = (char *) memchr(src, '\0', chunk);
+
+      if (end != NULL) chunk = end - src + 1;
+
+      if (dest != NULL) memcpy(dest + done, src, chunk);
+
+      done += chunk;
+
+      virtAddr += chunk;
+
+    }
+
+    // Force a '\0' at the end
+
+    if ((end == NULL) && (dest != NULL) && (maxlen > 0))
+
+      dest[(done < maxlen) ? done : maxlen - 1] = '\0';
+
+    return done;
+
+}
+
+
+
 //----------------------------------------------------------------------
 
 // MMU::Translate(uint32_t virtAddr, uint32_t *physAddr, int size, bool writing)
@@ -416,6 +826,46 @@ MMU::Translate(uint32_t virtAddr, uint32_t *physAddr, int size, bool writing)
 
 
 
+  // Look for the translation in the TLB. A write access to a page
+
+  // not known as writable goes through the page table, which raises
+
+  // the exception if needed
+
+  if (tlb != NULL) {
+
+    TLBEntry *entry = LookupTLB(translationTable->getAsid(), vpn);
+
+    if ((entry != NULL) && (entry->writable || !writing)) {
+
+      tlbHits++;
+
+      // The U bit is already set, the M bit may not be
+
+      if (writing && !entry->dirty) {
+
+	translationTable->getEntry(vpn)->M = true;
+
+	entry->dirty = true;
+
+      }
+
+      g_current_thread->GetProcessOwner()->stat->incrMemoryAccess();
+
+      *physAddr = (entry->physicalPage << pageShift) + offset;
+
+      DEBUG('h', (char *)"TLB hit, phys addr = 0x%x\n", *physAddr);
+
+      return NO_EXCEPTION;
+
+    }
+
+    tlbMisses++;
+
+  }
+
+
+
   /*
 
    * Complete the addres translation
@@ -438,9 +888,15 @@ MMU::Translate(uint32_t virtAddr, uint32_t *physAddr, int size, bool writing)
 
 
 
+  // Read the page table entry of the page
+
+  PageTableEntry *pte = translationTable->getEntry(vpn);
+
+
+
   // is the page correctly mapped ?
 
-  if (!translationTable->getBitReadAllowed(vpn) && !translationTable->getBitWriteAllowed(vpn)) {
+  if (!pte->readAllowed && !pte->writeAllowed) {
 
     DEBUG('h', (char *)"virtual page # %d not mapped !\n", vpn);
     
@@ -450,9 +906,23 @@ MMU::Translate(uint32_t virtAddr, uint32_t *physAddr, int size, bool writing)
 
 
 
+  // A page shared since a Fork is copied on the first write to it
+
+  // (see PageFaultManager::CopyOnWrite)
+
+  if (writing && !pte->writeAllowed && pte->cow) {
+
+    g_machine->RaiseException(READONLY_EXCEPTION, virtAddr);
+
+    pte = translationTable->getEntry(vpn);
+
+  }
+
+
+
   // Check access rights
 
-  if (writing && !translationTable->getBitWriteAllowed(vpn)) {
+  if (writing && !pte->writeAllowed) {
 
     DEBUG('h', (char *)"write access on read-only virtual page # %d !\n",
 
@@ -466,7 +936,7 @@ MMU::Translate(uint32_t virtAddr, uint32_t *physAddr, int size, bool writing)
 
   // If the page is not yet in main memory, run the page fault manager
 
-  if (!translationTable->getBitValid(vpn)) {
+  if (!pte->valid) {
 
     // Update statistics
 
@@ -482,9 +952,11 @@ MMU::Translate(uint32_t virtAddr, uint32_t *physAddr, int size, bool writing)
 
     g_machine->RaiseException(PAGEFAULT_EXCEPTION, virtAddr);
 
+    pte = translationTable->getEntry(vpn);
+
 
 
-    if (!translationTable->getBitValid(vpn)) {
+    if (!pte->valid) {
       
 
       printf(" %d Error: page fault failed (bit valid should be set to 1)\n",vpn);
@@ -499,15 +971,15 @@ MMU::Translate(uint32_t virtAddr, uint32_t *physAddr, int size, bool writing)
 
   // Make sure physical address is correct
 
-  if ((translationTable->getPhysicalPage(vpn) < 0)
+  if ((pte->physicalPage < 0)
 
-      || (translationTable->getPhysicalPage(vpn) >= g_cfg->NumPhysPages))
+      || (pte->physicalPage >= g_cfg->NumPhysPages))
 
     {
 
       DEBUG('h', (char *)"MMU: Translated physical page out of bounds (0x%x)\n",
 
-	    translationTable->getPhysicalPage(vpn));
+	    pte->physicalPage);
 
       return BUSERROR_EXCEPTION;
 
@@ -519,17 +991,35 @@ MMU::Translate(uint32_t virtAddr, uint32_t *physAddr, int size, bool writing)
 
   if (writing) {
 
-    translationTable->setBitM(vpn);
+    pte->M = true;
 
   } 
 
-  translationTable->setBitU(vpn);
+  pte->U = true;
+
+
+
+  // First access to a page read ahead by the page fault manager
+
+  if (pte->prefetched) {
+
+    pte->prefetched = false;
+
+    g_stats->incrPrefetchHits();
+
+  }
+
+  if (tlb != NULL)
+
+    FillTLB(translationTable->getAsid(), vpn);
 
   g_current_thread->GetProcessOwner()->stat->incrMemoryAccess();
 
 
 
-  *physAddr = translationTable->getPhysicalPage(vpn) * g_cfg->PageSize + offset;
+
+
+  *physAddr = pte->physicalPage * g_cfg->PageSize + offset;
 
   DEBUG('h', (char *)"phys addr = 0x%x\n", *physAddr);
 
@@ -537,3 +1027,179 @@ MMU::Translate(uint32_t virtAddr, uint32_t *physAddr, int size, bool writing)
 
 }
 
+
+
+
+
+//----------------------------------------------------------------------
+
+// MMU::LookupTLB
+
+/*!	Look for the translation of a virtual page in the TLB.
+
+//
+
+//	\param asid the address space of the page
+
+//	\param virtualPage the virtual page
+
+//	\return the TLB entry of the page, or NULL if it is not cached
+
+*/
+
+//----------------------------------------------------------------------
+
+TLBEntry *
+
+MMU::LookupTLB(int asid, int virtualPage)
+
+{
+
+  TLBEntry *set = &tlb[(virtualPage % tlbSets) * tlbWays];
+
+  for (int i = 0; i < tlbWays; i++) {
+
+    if (set[i].valid && (set[i].virtualPage == virtualPage)
+
+	&& (set[i].asid == asid))
+
+      return &set[i];
+
+  }
+
+  return NULL;
+
+}
+
+
+
+
+
+//----------------------------------------------------------------------
+
+// MMU::FillTLB
+
+/*!	Cache the translation of a virtual page in the TLB, once the
+
+//	page table has been looked up and the U bit set. The entry
+
+//	replaced is chosen round-robin within the set of the page.
+
+//
+
+//	\param asid the address space of the page
+
+//	\param virtualPage the virtual page
+
+*/
+
+//----------------------------------------------------------------------
+
+void
+
+MMU::FillTLB(int asid, int virtualPage)
+
+{
+
+  TLBEntry *entry = LookupTLB(asid, virtualPage);
+
+  if (entry == NULL) {
+
+    int set = virtualPage % tlbSets;
+
+    entry = &tlb[set * tlbWays + tlbVictim[set]];
+
+    tlbVictim[set] = (tlbVictim[set] + 1) % tlbWays;
+
+  }
+
+  entry->valid = true;
+
+  entry->asid = asid;
+
+  entry->virtualPage = virtualPage;
+
+  PageTableEntry *pte = translationTable->getEntry(virtualPage);
+
+  entry->physicalPage = pte->physicalPage;
+
+  entry->writable = pte->writeAllowed;
+
+  entry->dirty = pte->M;
+
+}
+
+
+
+
+
+//----------------------------------------------------------------------
+
+// MMU::InvalidateTLBEntry
+
+/*!	Forget the translation of a virtual page, if it is in the TLB.
+
+//	Called by the translation table each time the mapping, the
+
+//	access rights, or the U/M bits of the page are changed, so that
+
+//	the next access goes through the page table.
+
+//
+
+//	\param asid the address space of the page
+
+//	\param virtualPage the virtual page
+
+*/
+
+//----------------------------------------------------------------------
+
+void
+
+MMU::InvalidateTLBEntry(int asid, int virtualPage)
+
+{
+
+  if (tlb == NULL) return;
+
+  TLBEntry *entry = LookupTLB(asid, virtualPage);
+
+  if (entry != NULL) entry->valid = false;
+
+}
+
+
+
+
+
+//----------------------------------------------------------------------
+
+// MMU::FlushTLB
+
+/*!	Forget all the translations of an address space, when its
+
+//	translation table is destroyed.
+
+//
+
+//	\param asid the address space
+
+*/
+
+//----------------------------------------------------------------------
+
+void
+
+MMU::FlushTLB(int asid)
+
+{
+
+  if (tlb == NULL) return;
+
+  for (int i = 0; i < tlbSets * tlbWays; i++)
+
+    if (tlb[i].asid == asid) tlb[i].valid = false;
+
+}
+
@@ -28,6 +28,44 @@
 
 
 
+class Instruction;
+
+
+
+/*! \brief Defines an entry of the software TLB of the MMU
+
+//
+
+// An entry caches the translation of a virtual page of an address
+
+// space, identified by the ASID of its translation table. An entry
+
+// only exists while the U bit of the page is set, so that a hit never
+
+// has to set it again.
+
+*/
+
+class TLBEntry {
+
+ public:
+
+  bool valid;		//!< true if the entry holds a translation
+
+  int asid;		//!< Address space of the translation
+
+  int virtualPage;	//!< Translated virtual page
+
+  int physicalPage;	//!< Physical page of the virtual page
+
+  bool writable;	//!< Copy of the writeAllowed bit of the page
+
+  bool dirty;		//!< true if the M bit of the page is known to be set
+
+};
+
+
+
 /*! \brief Defines a MMU - Memory Management Unit
 
 */
@@ -56,6 +94,26 @@ public:
 
 
 
+  Instruction *FetchInstruction(uint32_t addr);
+
+  				//!< Read and decode the instruction at
+
+				//!< virtual address addr. Return NULL if a
+
+				//!< correct translation couldn't be found.
+
+
+
+  bool TranslateFetch(uint32_t addr, uint32_t *physAddr);
+
+  				//!< Translate the address of an instruction
+
+				//!< to be fetched. Return FALSE if a
+
+				//!< correct translation couldn't be found.
+
+
+
   bool WriteMem(uint32_t addr, int size, uint32_t value);
 
     				//!< Write or write 1, 2, or 4 bytes of virtual 
@@ -66,6 +124,36 @@ public:
 
   
 
+  int ReadMemBlock(uint32_t addr, char *dest, int size);
+
+  				//!< Copy size bytes of virtual memory (at
+
+				//!< addr) to dest, one page at a time.
+
+				//!< Return the number of bytes copied
+
+
+
+  int WriteMemBlock(uint32_t addr, const char *src, int size);
+
+  				//!< Copy size bytes from src to virtual
+
+				//!< memory (at addr), one page at a time.
+
+				//!< Return the number of bytes copied
+
+
+
+  int ReadMemString(uint32_t addr, char *dest, int maxlen);
+
+  				//!< Copy a '\0' terminated string of virtual
+
+				//!< memory (at addr) to dest, maxlen bytes
+
+				//!< at most. Return the number of bytes read
+
+
+
   ExceptionType Translate(uint32_t virtAddr, uint32_t *physAddr,
 
 			  int size, bool writing);
@@ -82,6 +170,28 @@ public:
 
   
 
+  void InvalidateTLBEntry(int asid, int virtualPage);
+
+  				//!< Forget the translation of a virtual page
+
+				//!< of address space asid, if cached
+
+
+
+  void FlushTLB(int asid);	//!< Forget all the translations of
+
+				//!< address space asid
+
+
+
+  // TLB counters, for statistics
+
+  uint64_t getTLBHits() { return tlbHits; }
+
+  uint64_t getTLBMisses() { return tlbMisses; }
+
+
+
   // NOTE: the hardware translation of virtual addresses in the user program
 
   // to physical addresses (relative to the beginning of "mainMemory")
@@ -90,6 +200,46 @@ public:
 
   TranslationTable *translationTable; //!< Pointer to the translation table
 
+
+
+private:
+
+  // Software TLB, caching the translations of the page tables. Entries
+
+  // are tagged by ASID, so that context switches do not flush it. The
+
+  // translation table invalidates the entries of the pages whose
+
+  // mapping, access rights, or U/M bits are changed.
+
+  TLBEntry *tlb;		//!< TLB entries, NULL if there is no TLB
+
+  int tlbSets;			//!< Number of sets of the TLB
+
+  int tlbWays;			//!< Number of entries per set
+
+  int *tlbVictim;		//!< Next entry to replace in each set
+
+				//!< (round-robin)
+
+  int pageShift;		//!< log2 of the page size
+
+
+
+  uint64_t tlbHits;		//!< Translations found in the TLB
+
+  uint64_t tlbMisses;		//!< Translations done with the page table
+
+
+
+  TLBEntry *LookupTLB(int asid, int virtualPage);
+
+  				//!< Return the TLB entry of a page, or NULL
+
+  void FillTLB(int asid, int virtualPage);
+
+  				//!< Cache the translation of a page
+
 };
 
 
@@ -992,3 +992,283 @@ DeallocBoundedArray(int8_t *ptr, size_t size)
 
 }
 
+
+
+#if defined(__x86_64__) && !defined(NACHOS_UCONTEXT)
+
+
+
+//! Initial value of the SSE control/status register (x86-64 ABI)
+
+#define INITIAL_MXCSR	0x1F80
+
+//! Initial value of the x87 control word (x86-64 ABI)
+
+#define INITIAL_FPUCW	0x037F
+
+
+
+//----------------------------------------------------------------------
+
+// SwitchHostStack
+
+/*! 	Save the callee-saved registers of the caller on its stack, store
+
+//	the stack pointer in *from, and resume the context saved at to.
+
+//	The other registers are saved by the caller, as for any function
+
+//	call (x86-64 System V ABI).
+
+//
+
+//	Layout of a saved context, from the saved stack pointer upwards:
+
+//	MXCSR and x87 control word (16 bytes), r15, r14, r13, r12, rbx,
+
+//	rbp, return address.
+
+*/
+
+//----------------------------------------------------------------------
+
+extern "C" void SwitchHostStack(void **from, void *to);
+
+
+
+asm(".text\n"
+
+    ".globl SwitchHostStack\n"
+
+    ".type SwitchHostStack, @function\n"
+
+    "SwitchHostStack:\n"
+
+    "	pushq %rbp\n"
+
+    "	pushq %rbx\n"
+
+    "	pushq %r12\n"
+
+    "	pushq %r13\n"
+
+    "	pushq %r14\n"
+
+    "	pushq %r15\n"
+
+    "	subq $16, %rsp\n"
+
+    "	stmxcsr (%rsp)\n"
+
+    "	fnstcw 4(%rsp)\n"
+
+    "	movq %rsp, (%rdi)\n"
+
+    "	movq %rsi, %rsp\n"
+
+    "	ldmxcsr (%rsp)\n"
+
+    "	fldcw 4(%rsp)\n"
+
+    "	addq $16, %rsp\n"
+
+    "	popq %r15\n"
+
+    "	popq %r14\n"
+
+    "	popq %r13\n"
+
+    "	popq %r12\n"
+
+    "	popq %rbx\n"
+
+    "	popq %rbp\n"
+
+    "	ret\n"
+
+    ".size SwitchHostStack, .-SwitchHostStack\n");
+
+
+
+//----------------------------------------------------------------------
+
+// InitHostContext
+
+/*! 	Build the initial context of a thread of the simulator, such
+
+//	that switching to it calls func on the given stack. func must
+
+//	never return.
+
+//
+
+//	\param ctx the context to initialize
+
+//	\param stack lowest address of the stack
+
+//	\param size size of the stack (in bytes)
+
+//	\param func function executed by the thread
+
+*/
+
+//----------------------------------------------------------------------
+
+void
+
+InitHostContext(HostContext *ctx, int8_t *stack, size_t size,
+
+		VoidNoArgFunctionPtr func)
+
+{
+
+  // Top of the stack, aligned on 16 bytes as required by the ABI
+
+  uint64_t *top = (uint64_t *) ALIGN_INF(stack + size, 16);
+
+
+
+  // Fake call of func: when SwitchHostStack returns to it, the stack
+
+  // pointer is the one of a function entry (top - 8)
+
+  *--top = 0;				// return address of func
+
+  *--top = (uint64_t) func;		// return address of SwitchHostStack
+
+  for (int i = 0; i < 6; i++)
+
+    *--top = 0;				// rbp, rbx, r12-r15
+
+  top -= 2;
+
+  ((uint32_t *) top)[0] = INITIAL_MXCSR;
+
+  ((uint16_t *) top)[2] = INITIAL_FPUCW;
+
+  ctx->sp = top;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// SwitchHostContext
+
+/*! 	Save the context of the running thread of the simulator, and
+
+//	resume another one. Returns when the saved context is resumed.
+
+//
+
+//	\param from where to save the current context
+
+//	\param to the context to resume
+
+*/
+
+//----------------------------------------------------------------------
+
+void
+
+SwitchHostContext(HostContext *from, HostContext *to)
+
+{
+
+  SwitchHostStack(&from->sp, to->sp);
+
+}
+
+
+
+#else // ucontext implementation
+
+
+
+//----------------------------------------------------------------------
+
+// InitHostContext
+
+/*! 	Build the initial context of a thread of the simulator, such
+
+//	that switching to it calls func on the given stack. func must
+
+//	never return.
+
+//
+
+//	\param ctx the context to initialize
+
+//	\param stack lowest address of the stack
+
+//	\param size size of the stack (in bytes)
+
+//	\param func function executed by the thread
+
+*/
+
+//----------------------------------------------------------------------
+
+void
+
+InitHostContext(HostContext *ctx, int8_t *stack, size_t size,
+
+		VoidNoArgFunctionPtr func)
+
+{
+
+  // NB: the gcc implementation of makecontext
+
+  //     interprets ss_sp as the stack BASE and not stack BOTTOM
+
+  //     (may not be portable to other architectures/compilers)
+
+  ASSERT(getcontext(&(ctx->buf)) == 0);
+
+  ctx->buf.uc_stack.ss_sp = stack;
+
+  ctx->buf.uc_stack.ss_size = size;
+
+  ctx->buf.uc_stack.ss_flags = 0;
+
+  ctx->buf.uc_link = NULL;
+
+  makecontext(&ctx->buf, func, 0);
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// SwitchHostContext
+
+/*! 	Save the context of the running thread of the simulator, and
+
+//	resume another one. Returns when the saved context is resumed.
+
+//
+
+//	\param from where to save the current context
+
+//	\param to the context to resume
+
+*/
+
+//----------------------------------------------------------------------
+
+void
+
+SwitchHostContext(HostContext *from, HostContext *to)
+
+{
+
+  swapcontext(&(from->buf), &(to->buf));
+
+}
+
+
+
+#endif
+
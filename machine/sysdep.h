@@ -132,7 +132,7 @@ extern int Random();
 
 /* Allocate, de-allocate an array, such that de-referencing
 
-// just beyond either end of the array will cause an error
+// just beyond either end of the array will cause an error
 
 */
 
@@ -143,10 +143,53 @@ extern int8_t*AllocBoundedArray(size_t size);
 extern void DeallocBoundedArray(int8_t *p, size_t size);
 
 
+/* Low-level context switch between the threads of the simulator.
+
+// On x86-64, only the callee-saved registers are saved, on the stack
+
+// of the thread being left: no system call is made. Elsewhere, or
+
+// when NACHOS_UCONTEXT is defined, the ucontext routines of the C
+
+// library are used.
+
+*/
+
+#if defined(__x86_64__) && !defined(NACHOS_UCONTEXT)
+
+typedef struct {
+
+  void *sp;		// Stack pointer, the saved registers are on top
+
+} HostContext;
+
+#else
+
+#include <ucontext.h>
+
+typedef struct {
+
+  ucontext_t buf;
+
+} HostContext;
+
+#endif
+
+
+
+extern void InitHostContext(HostContext *ctx, int8_t *stack, size_t size,
+
+			    VoidNoArgFunctionPtr func);
+
+extern void SwitchHostContext(HostContext *from, HostContext *to);
+
+
+
+
 
 /* Other C library routines that are used by Nachos.
 
-// These are assumed to be portable, so we don't include a wrapper.
+// These are assumed to be portable, so we don't include a wrapper.
 
 */
 
@@ -0,0 +1,1322 @@
+/*! \file threaded.cc
+
+// \brief Threaded execution engine of the MIPS simulator
+
+//
+
+//   Alternative to the Machine::OneInstruction interpreter, selected
+
+//   with "ExecutionEngine = Threaded" in the configuration file.
+
+//
+
+//   User code is executed by basic blocks. The decoded instruction
+
+//   cache (see decodecache.h) associates each instruction with a
+
+//   pre-resolved handler, and knows the length of the basic block
+
+//   starting at each instruction. A block is run by calling the
+
+//   handlers one after the other, without going back to the main loop,
+
+//   the decoder or Interrupt::OneTick between two instructions.
+
+//
+
+//   The engine produces exactly the same results as the interpreter,
+
+//   including statistics and the time at which interrupts fire. As in
+
+//   Machine::Run, the execution time of the instructions is charged
+
+//   in one batch when the next interrupt is due:
+
+//     - the address of the first instruction of a block is translated
+
+//       as by the interpreter. Since the following instructions of a
+
+//       block are in the same page, their translation cannot change
+
+//       without an exception, which ends the block: only the
+
+//       corresponding statistics are updated for them;
+
+//     - each handler performs the delayed load and the update of the
+
+//       program counters done at the end of OneInstruction;
+
+//     - as in OneInstruction, each handler gets a copy of the decoded
+
+//       instruction: a page fault may evict the page of the code while
+
+//       the instruction executes, and reuse its entries of the cache;
+
+//     - the block is left as soon as the simulated time reaches the
+
+//       next pending interrupt (see Interrupt::NextEventTime), as soon
+
+//       as an exception is raised, or as soon as the program counter
+
+//       does not follow the block (taken branch, or block entered in
+
+//       a delay slot).
+
+//
+
+//   The less frequent instructions are executed by the generic
+
+//   handler, which calls Machine::ExecuteInstruction.
+
+//
+
+//   DO NOT CHANGE -- part of the machine emulation
+
+//
+
+//  Copyright (c) 1999-2000 INSA de Rennes.
+
+//  All rights reserved.
+
+//  See copyright_insa.h for copyright notice and limitation
+
+//  of liability and disclaimer of warranty provisions.
+
+*/
+
+
+
+#include "machine/machine.h"
+
+#include "machine/mipssim.h"
+
+#include "kernel/system.h"
+
+#include "kernel/thread.h"
+
+
+
+//----------------------------------------------------------------------
+
+// Machine::RunThreaded
+
+/*! 	Main loop of the threaded engine, replacing the loop of
+
+//	Machine::Run. Never returns.
+
+*/
+
+//----------------------------------------------------------------------
+
+void
+
+Machine::RunThreaded()
+
+{
+
+  deadline = NextDeadline();
+
+  Time ticks;
+
+
+
+  for (;;) {
+
+      if (RunBlock())
+
+	continue;
+
+
+
+      // The next interrupt is due, or an exception was raised:
+
+      // charge the execution time of the executed instructions
+
+      // and check for interrupts, as the interpreter does
+
+      this->status = USER_MODE;
+
+      ticks = pendingTicks;
+
+      pendingTicks = 0;
+
+      interrupt->OneTick(ticks);
+
+      deadline = NextDeadline();
+
+  }
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// Machine::RunBlock
+
+/*! 	Execute the basic block starting at the current program counter,
+
+//	or the beginning of it. The execution time of the instructions
+
+//	is added to pendingTicks.
+
+//
+
+//  \return false if the block was left because of an exception, or
+
+//	because the deadline was reached (RaiseException resets it, so
+
+//	that a page fault also ends the block)
+
+*/
+
+//----------------------------------------------------------------------
+
+bool
+
+Machine::RunBlock()
+
+{
+
+  uint32_t pc = int_registers[PC_REG];
+
+  uint32_t physAddr;
+
+  Instruction *instrs;
+
+  Instruction instr;
+
+  InstrHandler *handlers;
+
+  int len, i;
+
+
+
+  // Fetch the first instruction of the block
+
+  if (!mmu->TranslateFetch(pc, &physAddr))
+
+    return false;
+
+  if (physAddr & 0x3) {
+
+    // Mis-aligned program counter, leave it to the interpreter
+
+    instr = *decodeCache->Fetch(physAddr);
+
+    g_current_thread->GetProcessOwner()->stat->incrNumInstruction();
+
+    if (!ExecuteInstruction(&instr))
+
+      return false;
+
+    pendingTicks += USER_TICK;
+
+    return (g_stats->getTotalTicks() + pendingTicks < deadline);
+
+  }
+
+  len = decodeCache->FetchBlock(physAddr, &instrs, &handlers);
+
+
+
+  ProcessStat *stat = g_current_thread->GetProcessOwner()->stat;
+
+
+
+  for (i = 0; ; ) {
+
+    stat->incrNumInstruction();
+
+    instr = instrs[i];
+
+    if (!(*handlers[i])(this, &instr))
+
+      return false;
+
+
+
+    // The instruction has been executed, advance simulated time
+
+    pendingTicks += USER_TICK;
+
+    if (g_stats->getTotalTicks() + pendingTicks >= deadline)
+
+      return false;
+
+
+
+    // Stop if the next instruction is not the next one of the block
+
+    i++;
+
+    pc += 4;
+
+    physAddr += 4;
+
+    if ((i == len) || ((uint32_t) int_registers[PC_REG] != pc)
+
+	|| !decodeCache->IsValid(physAddr))
+
+      return true;
+
+
+
+    // Same statistics as MMU::TranslateFetch, the translation of the
+
+    // page being known
+
+    stat->incrMemoryAccess();
+
+    stat->incrMemoryAccess();
+
+    stat->incrMemoryAccess();
+
+  }
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// Advance
+
+/*!	End of the execution of an instruction, as in
+
+//	Machine::ExecuteInstruction: do the delayed load, and
+
+//	advance the program counters.
+
+//
+
+//	\param m the machine
+
+//	\param pcAfter the value of the next program counter
+
+//	\param loadReg register of the delayed load of the instruction
+
+//	\param loadValue value of the delayed load of the instruction
+
+*/
+
+//----------------------------------------------------------------------
+
+static inline void
+
+Advance(Machine *m, int pcAfter, int loadReg, int loadValue)
+
+{
+
+  m->DelayedLoad(loadReg, loadValue);
+
+  m->int_registers[PREVPC_REG] = m->int_registers[PC_REG];
+
+  m->int_registers[PC_REG] = m->int_registers[NEXTPC_REG];
+
+  m->int_registers[NEXTPC_REG] = pcAfter;
+
+}
+
+
+
+//! Advance to the next instruction, without delayed load
+
+#define NEXT(m) Advance(m, (m)->int_registers[NEXTPC_REG] + 4, 0, 0)
+
+
+
+//! Value of an integer register
+
+#define REG(r) (m->int_registers[(int)(r)])
+
+
+
+//! Target of a conditional branch
+
+#define BRANCH_TARGET(m, i) ((m)->int_registers[NEXTPC_REG] + IndexToAddr((i)->extra))
+
+
+
+//----------------------------------------------------------------------
+
+// Instruction handlers. Each of them has the same behavior as the
+
+// corresponding case in Machine::ExecuteInstruction
+
+//----------------------------------------------------------------------
+
+
+
+static bool
+
+ExecGeneric(Machine *m, Instruction *instr)
+
+{
+
+  return m->ExecuteInstruction(instr);
+
+}
+
+
+
+static bool
+
+ExecAdd(Machine *m, Instruction *instr)
+
+{
+
+  int sum = REG(instr->rs) + REG(instr->rt);
+
+  if (!((REG(instr->rs) ^ REG(instr->rt)) & SIGN_BIT) &&
+
+      ((REG(instr->rs) ^ sum) & SIGN_BIT)) {
+
+    m->RaiseException(OVERFLOW_EXCEPTION, 0);
+
+    return false;
+
+  }
+
+  REG(instr->rd) = sum;
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecAddi(Machine *m, Instruction *instr)
+
+{
+
+  int sum = REG(instr->rs) + instr->extra;
+
+  if (!((REG(instr->rs) ^ instr->extra) & SIGN_BIT) &&
+
+      ((instr->extra ^ sum) & SIGN_BIT)) {
+
+    m->RaiseException(OVERFLOW_EXCEPTION, 0);
+
+    return false;
+
+  }
+
+  REG(instr->rt) = sum;
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecAddiu(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rt) = REG(instr->rs) + instr->extra;
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecAddu(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rd) = REG(instr->rs) + REG(instr->rt);
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecAnd(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rd) = REG(instr->rs) & REG(instr->rt);
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecAndi(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rt) = REG(instr->rs) & (instr->extra & 0xffff);
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecBeq(Machine *m, Instruction *instr)
+
+{
+
+  int pcAfter = m->int_registers[NEXTPC_REG] + 4;
+
+  if (REG(instr->rs) == REG(instr->rt))
+
+    pcAfter = BRANCH_TARGET(m, instr);
+
+  Advance(m, pcAfter, 0, 0);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecBne(Machine *m, Instruction *instr)
+
+{
+
+  int pcAfter = m->int_registers[NEXTPC_REG] + 4;
+
+  if (REG(instr->rs) != REG(instr->rt))
+
+    pcAfter = BRANCH_TARGET(m, instr);
+
+  Advance(m, pcAfter, 0, 0);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecBgez(Machine *m, Instruction *instr)
+
+{
+
+  int pcAfter = m->int_registers[NEXTPC_REG] + 4;
+
+  if (!(REG(instr->rs) & SIGN_BIT))
+
+    pcAfter = BRANCH_TARGET(m, instr);
+
+  Advance(m, pcAfter, 0, 0);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecBgtz(Machine *m, Instruction *instr)
+
+{
+
+  int pcAfter = m->int_registers[NEXTPC_REG] + 4;
+
+  if (REG(instr->rs) > 0)
+
+    pcAfter = BRANCH_TARGET(m, instr);
+
+  Advance(m, pcAfter, 0, 0);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecBlez(Machine *m, Instruction *instr)
+
+{
+
+  int pcAfter = m->int_registers[NEXTPC_REG] + 4;
+
+  if (REG(instr->rs) <= 0)
+
+    pcAfter = BRANCH_TARGET(m, instr);
+
+  Advance(m, pcAfter, 0, 0);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecBltz(Machine *m, Instruction *instr)
+
+{
+
+  int pcAfter = m->int_registers[NEXTPC_REG] + 4;
+
+  if (REG(instr->rs) & SIGN_BIT)
+
+    pcAfter = BRANCH_TARGET(m, instr);
+
+  Advance(m, pcAfter, 0, 0);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecJ(Machine *m, Instruction *instr)
+
+{
+
+  int pcAfter = m->int_registers[NEXTPC_REG] + 4;
+
+  Advance(m, (pcAfter & 0xf0000000) | IndexToAddr(instr->extra), 0, 0);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecJal(Machine *m, Instruction *instr)
+
+{
+
+  int pcAfter = m->int_registers[NEXTPC_REG] + 4;
+
+  m->int_registers[R31] = m->int_registers[NEXTPC_REG] + 4;
+
+  Advance(m, (pcAfter & 0xf0000000) | IndexToAddr(instr->extra), 0, 0);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecJr(Machine *m, Instruction *instr)
+
+{
+
+  Advance(m, REG(instr->rs), 0, 0);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecJalr(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rd) = m->int_registers[NEXTPC_REG] + 4;
+
+  Advance(m, REG(instr->rs), 0, 0);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecLb(Machine *m, Instruction *instr)
+
+{
+
+  uint32_t value;
+
+  int addr = REG(instr->rs) + instr->extra;
+
+  if (!m->mmu->ReadMem(addr, 1, &value, false))
+
+    return false;
+
+  if ((value & 0x80) && (instr->opCode == OP_LB))
+
+    value |= 0xffffff00;
+
+  else
+
+    value &= 0xff;
+
+  Advance(m, m->int_registers[NEXTPC_REG] + 4, instr->rt, value);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecLh(Machine *m, Instruction *instr)
+
+{
+
+  uint32_t value;
+
+  int addr = REG(instr->rs) + instr->extra;
+
+  if (addr & 0x1) {
+
+    m->RaiseException(ADDRESSERROR_EXCEPTION, addr);
+
+    return false;
+
+  }
+
+  if (!m->mmu->ReadMem(addr, 2, &value, false))
+
+    return false;
+
+  if ((value & 0x8000) && (instr->opCode == OP_LH))
+
+    value |= 0xffff0000;
+
+  else
+
+    value &= 0xffff;
+
+  Advance(m, m->int_registers[NEXTPC_REG] + 4, instr->rt, value);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecLui(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rt) = instr->extra << 16;
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecLw(Machine *m, Instruction *instr)
+
+{
+
+  uint32_t value;
+
+  int addr = REG(instr->rs) + instr->extra;
+
+  if (addr & 0x3) {
+
+    m->RaiseException(ADDRESSERROR_EXCEPTION, addr);
+
+    return false;
+
+  }
+
+  if (!m->mmu->ReadMem(addr, 4, &value, false))
+
+    return false;
+
+  Advance(m, m->int_registers[NEXTPC_REG] + 4, instr->rt, value);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecMfhi(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rd) = m->int_registers[HI_REG];
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecMflo(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rd) = m->int_registers[LO_REG];
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecNor(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rd) = ~(REG(instr->rs) | REG(instr->rt));
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+// NB: same as the interpreter, which only uses rs
+
+static bool
+
+ExecOr(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rd) = REG(instr->rs) | REG(instr->rs);
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecOri(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rt) = REG(instr->rs) | (instr->extra & 0xffff);
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecSb(Machine *m, Instruction *instr)
+
+{
+
+  if (!m->mmu->WriteMem((unsigned) (REG(instr->rs) + instr->extra), 1,
+
+			REG(instr->rt)))
+
+    return false;
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecSh(Machine *m, Instruction *instr)
+
+{
+
+  if (!m->mmu->WriteMem((unsigned) (REG(instr->rs) + instr->extra), 2,
+
+			REG(instr->rt)))
+
+    return false;
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecSw(Machine *m, Instruction *instr)
+
+{
+
+  if (!m->mmu->WriteMem((unsigned) (REG(instr->rs) + instr->extra), 4,
+
+			REG(instr->rt)))
+
+    return false;
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecSll(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rd) = REG(instr->rt) << instr->extra;
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecSllv(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rd) = REG(instr->rt) << (REG(instr->rs) & 0x1f);
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecSlt(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rd) = (REG(instr->rs) < REG(instr->rt)) ? 1 : 0;
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecSlti(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rt) = (REG(instr->rs) < instr->extra) ? 1 : 0;
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecSltiu(Machine *m, Instruction *instr)
+
+{
+
+  unsigned int rs = REG(instr->rs);
+
+  unsigned int imm = instr->extra;
+
+  REG(instr->rt) = (rs < imm) ? 1 : 0;
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecSltu(Machine *m, Instruction *instr)
+
+{
+
+  unsigned int rs = REG(instr->rs);
+
+  unsigned int rt = REG(instr->rt);
+
+  REG(instr->rd) = (rs < rt) ? 1 : 0;
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecSra(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rd) = REG(instr->rt) >> instr->extra;
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecSrav(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rd) = REG(instr->rt) >> (REG(instr->rs) & 0x1f);
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+// NB: same as the interpreter, which shifts a signed value
+
+static bool
+
+ExecSrl(Machine *m, Instruction *instr)
+
+{
+
+  int tmp = REG(instr->rt);
+
+  tmp >>= instr->extra;
+
+  REG(instr->rd) = tmp;
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecSrlv(Machine *m, Instruction *instr)
+
+{
+
+  int tmp = REG(instr->rt);
+
+  tmp >>= (REG(instr->rs) & 0x1f);
+
+  REG(instr->rd) = tmp;
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecSub(Machine *m, Instruction *instr)
+
+{
+
+  int diff = REG(instr->rs) - REG(instr->rt);
+
+  if (((REG(instr->rs) ^ REG(instr->rt)) & SIGN_BIT) &&
+
+      ((REG(instr->rs) ^ diff) & SIGN_BIT)) {
+
+    m->RaiseException(OVERFLOW_EXCEPTION, 0);
+
+    return false;
+
+  }
+
+  REG(instr->rd) = diff;
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecSubu(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rd) = REG(instr->rs) - REG(instr->rt);
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecXor(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rd) = REG(instr->rs) ^ REG(instr->rt);
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+static bool
+
+ExecXori(Machine *m, Instruction *instr)
+
+{
+
+  REG(instr->rt) = REG(instr->rs) ^ (instr->extra & 0xffff);
+
+  NEXT(m);
+
+  return true;
+
+}
+
+
+
+//----------------------------------------------------------------------
+
+// ResolveHandler
+
+/*!	Return the handler executing an opcode in the threaded engine.
+
+//
+
+//	\param opCode the opcode of a decoded instruction
+
+//	\param endsBlock set to true if the instruction is a branch
+
+//	\return the handler
+
+*/
+
+//----------------------------------------------------------------------
+
+InstrHandler
+
+ResolveHandler(int opCode, bool *endsBlock)
+
+{
+
+  *endsBlock = false;
+
+  switch (opCode) {
+
+    case OP_ADD:	return ExecAdd;
+
+    case OP_ADDI:	return ExecAddi;
+
+    case OP_ADDIU:	return ExecAddiu;
+
+    case OP_ADDU:	return ExecAddu;
+
+    case OP_AND:	return ExecAnd;
+
+    case OP_ANDI:	return ExecAndi;
+
+    case OP_LB:
+
+    case OP_LBU:	return ExecLb;
+
+    case OP_LH:
+
+    case OP_LHU:	return ExecLh;
+
+    case OP_LUI:	return ExecLui;
+
+    case OP_LW:		return ExecLw;
+
+    case OP_MFHI:	return ExecMfhi;
+
+    case OP_MFLO:	return ExecMflo;
+
+    case OP_NOR:	return ExecNor;
+
+    case OP_OR:		return ExecOr;
+
+    case OP_ORI:	return ExecOri;
+
+    case OP_SB:		return ExecSb;
+
+    case OP_SH:		return ExecSh;
+
+    case OP_SW:		return ExecSw;
+
+    case OP_SLL:	return ExecSll;
+
+    case OP_SLLV:	return ExecSllv;
+
+    case OP_SLT:	return ExecSlt;
+
+    case OP_SLTI:	return ExecSlti;
+
+    case OP_SLTIU:	return ExecSltiu;
+
+    case OP_SLTU:	return ExecSltu;
+
+    case OP_SRA:	return ExecSra;
+
+    case OP_SRAV:	return ExecSrav;
+
+    case OP_SRL:	return ExecSrl;
+
+    case OP_SRLV:	return ExecSrlv;
+
+    case OP_SUB:	return ExecSub;
+
+    case OP_SUBU:	return ExecSubu;
+
+    case OP_XOR:	return ExecXor;
+
+    case OP_XORI:	return ExecXori;
+
+  }
+
+
+
+  // Branches end the basic block after their delay slot
+
+  *endsBlock = true;
+
+  switch (opCode) {
+
+    case OP_BEQ:	return ExecBeq;
+
+    case OP_BNE:	return ExecBne;
+
+    case OP_BGEZ:	return ExecBgez;
+
+    case OP_BGTZ:	return ExecBgtz;
+
+    case OP_BLEZ:	return ExecBlez;
+
+    case OP_BLTZ:	return ExecBltz;
+
+    case OP_J:		return ExecJ;
+
+    case OP_JAL:	return ExecJal;
+
+    case OP_JR:		return ExecJr;
+
+    case OP_JALR:	return ExecJalr;
+
+    case OP_BGEZAL:
+
+    case OP_BLTZAL:
+
+    case OP_BC1F:
+
+    case OP_BC1T:	return ExecGeneric;
+
+  }
+
+
+
+  // All other instructions
+
+  *endsBlock = false;
+
+  return ExecGeneric;
+
+}
+
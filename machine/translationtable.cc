@@ -32,217 +32,81 @@
 
 
 
-//----------------------------------------------------------------------
-
-// TranslationTable::TranslationTable
-
-/*!  Constructor.A llocate the page table entries
-
-*/
-
-//----------------------------------------------------------------------
-
-TranslationTable::TranslationTable() {
-
-
-
-  // Init private fields
-
-  maxNumPages = g_cfg->MaxVirtPages;
-
-  
-
-  DEBUG('h',(char *)"Allocationg translation table for %d pages (%ld kB)\n",
-
-	maxNumPages, ((long long)maxNumPages*g_cfg->PageSize) >> 10);
-
-  pageTable = new PageTableEntry[maxNumPages];
-
-
-
-}
-
-
-
-//----------------------------------------------------------------------
-
-// TranslationTable::~TranslationTable()
-
-/*!  Destructor. De-allocate the memory management structures
-
-*/
-
-//----------------------------------------------------------------------
-
-TranslationTable::~TranslationTable() {
-
- delete [] pageTable;
-
- DEBUG('h',(char *)"Translation table destroyed");
-
- 
-
-}
-
-
-
-//----------------------------------------------------------------------
-
-// TranslationTable::getMaxNumPages()
-
-/*! Get the number of pages that can be translated using the
-
-//  translation table.
-
-*/
-
-//----------------------------------------------------------------------
-
-int TranslationTable::getMaxNumPages() {
-
-  return maxNumPages;
-
-}
-
-
-
-//----------------------------------------------------------------------
-
-// TranslationTable::setPhysicalPage
-
-/*!  Set the physical page of a virtual page
-
-//   \param virtualPage : the virtual page
-
-//   \param physicalPage : the physical page
-
-*/
-
-//----------------------------------------------------------------------
-
-void TranslationTable::setPhysicalPage(int virtualPage, int physicalPage) {
-
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
-
-  pageTable[virtualPage].physicalPage = physicalPage;
-
-}
-
-
-
-//----------------------------------------------------------------------
-
-//  TranslationTable::getPhysicalPage
-
-/*!  Get the physical page of a virtual page
-
-//   \param virtualPage : the virtual page
-
-//   \return the physical page
-
-*/
-
-//----------------------------------------------------------------------
+// ASID of the next translation table created. ASIDs are never
 
-int TranslationTable::getPhysicalPage(int virtualPage) {
+// reused, so that the TLB entries of a destroyed table never match.
 
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
+int TranslationTable::nextAsid = 0;
 
-  return pageTable[virtualPage].physicalPage;
-
-}
-
-
-
-//----------------------------------------------------------------------
 
-//  TranslationTable::setAddrDisk
 
-/*!  Set the disk address of a virtual page
+// Entry returned for the pages of the second-level tables not
 
-//   \param virtualPage : the virtual page
+// allocated yet: the page is unmapped
 
-//   \param addrDisk : the address on disk (page number in swap, bytes in
+PageTableEntry TranslationTable::unmappedEntry;
 
-//                     executable file)
 
-*/
 
 //----------------------------------------------------------------------
 
-void TranslationTable::setAddrDisk(int virtualPage, int addrDisk) {
-
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
-
-  pageTable[virtualPage].addrDisk = addrDisk;
-
-}
-
-
-
-//----------------------------------------------------------------------
+// TranslationTable::TranslationTable
 
-//  TranslationTable::getAddrDisk
+/*!  Constructor. Allocate the page table entries. In SingleLevel mode,
 
-/*!  Get the disk address of a virtual page
+//   one entry is allocated for each of the MaxVirtPages pages. In
 
-//   \param virtualPage : the virtual page
+//   DualLevel mode, only the first level is allocated, the second-level
 
-//   \return the disk address (page number in swap, or bytes in exec file)
+//   tables are allocated when one of their entries is first modified.
 
 */
 
 //----------------------------------------------------------------------
 
-int TranslationTable::getAddrDisk(int virtualPage) {
+TranslationTable::TranslationTable() {
 
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
 
-  return pageTable[virtualPage].addrDisk;
-
-}
 
+  // Init private fields
 
+  maxNumPages = g_cfg->MaxVirtPages;
 
-//----------------------------------------------------------------------
+  asid = nextAsid++;
 
-//  TranslationTable::setBitValid
+  mode = g_cfg->TranslationTableMode;
 
-/*!  Set the bit valid of a virtual page
+  pageTable = NULL;
 
-//   \param virtualPage : the virtual page
+  directory = NULL;
 
-*/
+  
 
-//----------------------------------------------------------------------
+  if (mode == SingleLevel) {
 
-void TranslationTable::setBitValid(int virtualPage) {
+    DEBUG('h',(char *)"Allocationg translation table for %d pages (%ld kB)\n",
 
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
+	  maxNumPages, ((long long)maxNumPages*g_cfg->PageSize) >> 10);
 
-  pageTable[virtualPage].valid = true;
+    pageTable = new PageTableEntry[maxNumPages];
 
-}
+  }
 
+  else {
 
+    directorySize = (maxNumPages + SECOND_LEVEL_SIZE - 1) >> SECOND_LEVEL_SHIFT;
 
-//----------------------------------------------------------------------
+    DEBUG('h',(char *)"Allocationg two-level translation table for %d pages (%d second-level tables)\n",
 
-//  TranslationTable::clearBitValid
+	  maxNumPages, directorySize);
 
-/*!  Clear the bit valid of a virtual page
+    directory = new PageTableEntry*[directorySize];
 
-//   \param virtualPage : the virtual page
+    for (int i = 0; i < directorySize; i++)
 
-*/
+      directory[i] = NULL;
 
-//----------------------------------------------------------------------
-
-void TranslationTable::clearBitValid(int virtualPage) {
-
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
-
-  pageTable[virtualPage].valid = false;
+  }
 
 }
 
@@ -250,67 +114,35 @@ void TranslationTable::clearBitValid(int virtualPage) {
 
 //----------------------------------------------------------------------
 
-//   TranslationTable::getBitValid
-
-/*!  Get the bit valid of a virtual page
-
-//   \param virtualPage : the virtual page
-
-//   \return value of the bit valid
-
-*/
-
-//----------------------------------------------------------------------
-
-bool TranslationTable::getBitValid(int virtualPage) {
-
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
-
-  return  pageTable[virtualPage].valid;
-
-}
-
-
-
-//----------------------------------------------------------------------
-
-//  TranslationTable::setBitIo
-
-/*!  Set the bit io of a virtual page
+// TranslationTable::~TranslationTable()
 
-//   \param virtualPage : the virtual page
+/*!  Destructor. De-allocate the memory management structures
 
 */
 
 //----------------------------------------------------------------------
 
-void TranslationTable::setBitIo(int virtualPage) {
-
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
+TranslationTable::~TranslationTable() {
 
-  pageTable[virtualPage].io = true;
+ g_machine->mmu->FlushTLB(asid);
 
-}
+ if (mode == SingleLevel)
 
+   delete [] pageTable;
 
+ else {
 
-//----------------------------------------------------------------------
+   for (int i = 0; i < directorySize; i++)
 
-//  TranslationTable::clearBitIo
+     delete [] directory[i];
 
-/*!  Clear the bit io of a virtual page
-
-//   \param virtualPage : the virtual page
-
-*/
-
-//----------------------------------------------------------------------
+   delete [] directory;
 
-void TranslationTable::clearBitIo(int virtualPage) {
+ }
 
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
+ DEBUG('h',(char *)"Translation table destroyed");
 
-  pageTable[virtualPage].io = false;
+ 
 
 }
 
@@ -318,33 +150,11 @@ void TranslationTable::clearBitIo(int virtualPage) {
 
 //----------------------------------------------------------------------
 
-//   TranslationTable::getBitIo
-
-/*!  Get the bit io of a virtual page
-
-//   \param virtualPage : the virtual page
-
-//   \return value of the bit io
-
-*/
-
-//----------------------------------------------------------------------
-
-bool TranslationTable::getBitIo(int virtualPage) {
-
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
+// TranslationTable::ShootDown
 
-  return pageTable[virtualPage].io;
-
-}
-
-
-
-//----------------------------------------------------------------------
+/*!  Invalidate the TLB entry of a virtual page, whose translation
 
-//  TranslationTable::setBitSwap
-
-/*!  Set the bit swap of a virtual page
+//   or U/M bits are being changed by the kernel
 
 //   \param virtualPage : the virtual page
 
@@ -352,11 +162,11 @@ bool TranslationTable::getBitIo(int virtualPage) {
 
 //----------------------------------------------------------------------
 
-void TranslationTable::setBitSwap(int virtualPage) {
+void TranslationTable::ShootDown(int virtualPage) {
 
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
+  if ((g_machine != NULL) && (g_machine->mmu != NULL))
 
-  pageTable[virtualPage].swap = true;
+    g_machine->mmu->InvalidateTLBEntry(asid, virtualPage);
 
 }
 
@@ -364,67 +174,35 @@ void TranslationTable::setBitSwap(int virtualPage) {
 
 //----------------------------------------------------------------------
 
-//  TranslationTable::clearBitSwap
-
-/*!  Clear the bit swap of a virtual page
-
-//   \param virtualPage : the virtual page
-
-*/
-
-//----------------------------------------------------------------------
-
-void TranslationTable::clearBitSwap(int virtualPage) {
+// TranslationTable::allocSecondLevel
 
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
+/*!  Allocate the second-level table of a virtual page, in DualLevel
 
-  pageTable[virtualPage].swap = false;
-
-}
-
-
-
-//----------------------------------------------------------------------
-
-//   TranslationTable::getBitSwap
-
-/*!  Get the bit swap of a virtual page
+//   mode. Its entries are initially unmapped.
 
 //   \param virtualPage : the virtual page
 
-//   \return value of the bit swap
+//   \return the second-level table
 
 */
 
 //----------------------------------------------------------------------
 
-bool TranslationTable::getBitSwap(int virtualPage) {
+PageTableEntry *TranslationTable::allocSecondLevel(int virtualPage) {
 
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
+  PageTableEntry **table = &directory[virtualPage >> SECOND_LEVEL_SHIFT];
 
-  return pageTable[virtualPage].swap;
+  ASSERT(*table == NULL);
 
-}
+  DEBUG('h',(char *)"Allocating second-level table for pages %d to %d\n",
 
+	virtualPage & ~(SECOND_LEVEL_SIZE - 1),
 
+	(virtualPage | (SECOND_LEVEL_SIZE - 1)));
 
-//----------------------------------------------------------------------
-
-//  TranslationTable::setBitReadAllowed
-
-/*!  Set the bit readAllowed of a virtual page
-
-//   \param virtualPage : the virtual page
-
-*/
-
-//----------------------------------------------------------------------
+  *table = new PageTableEntry[SECOND_LEVEL_SIZE];
 
-void TranslationTable::setBitReadAllowed(int virtualPage) {
-
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
-
-  pageTable[virtualPage].readAllowed = true;
+  return *table;
 
 }
 
@@ -432,69 +210,37 @@ void TranslationTable::setBitReadAllowed(int virtualPage) {
 
 //----------------------------------------------------------------------
 
-//  TranslationTable::clearBitReadAllowed
-
-/*!  Clear the bit readAllowed of a virtual page
-
-//   \param virtualPage : the virtual page
+// TranslationTable::setRangeAccess
 
-*/
+/*!  Set the access rights of a range of virtual pages
 
-//----------------------------------------------------------------------
+//   \param firstPage : the first virtual page of the range
 
-void TranslationTable::clearBitReadAllowed(int virtualPage) {
+//   \param numPages : the number of pages of the range
 
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
+//   \param readAllowed : true if the pages can be read
 
-  pageTable[virtualPage].readAllowed = false;
-
-}
-
-
-
-//----------------------------------------------------------------------
-
-//   TranslationTable::getBitReadAllowed
-
-/*!  Get the bit readAllowed of a virtual page
-
-//   \param virtualPage : the virtual page
-
-//   \return value of the bit readAllowed
+//   \param writeAllowed : true if the pages can be written
 
 */
 
 //----------------------------------------------------------------------
 
-bool TranslationTable::getBitReadAllowed(int virtualPage) {
-
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
+void TranslationTable::setRangeAccess(int firstPage, int numPages,
 
-  return pageTable[virtualPage].readAllowed;
+				      bool readAllowed, bool writeAllowed) {
 
-}
+  for (int i = firstPage; i < firstPage + numPages; i++) {
 
+    PageTableEntry *entry = allocEntry(i);
 
+    entry->readAllowed = readAllowed;
 
+    entry->writeAllowed = writeAllowed;
 
+    ShootDown(i);
 
-//----------------------------------------------------------------------
-
-//  TranslationTable::setBitWriteAllowed
-
-/*!  Set the bit writeAllowed of a virtual page
-
-//   \param virtualPage : the virtual page
-
-*/
-
-//----------------------------------------------------------------------
-
-void TranslationTable::setBitWriteAllowed(int virtualPage) {
-
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
-
-  pageTable[virtualPage].writeAllowed = true;
+  }
 
 }
 
@@ -502,101 +248,51 @@ void TranslationTable::setBitWriteAllowed(int virtualPage) {
 
 //----------------------------------------------------------------------
 
-//  TranslationTable::clearBitWriteAllowed
+// TranslationTable::setRangeAddrDisk
 
-/*!  Clear the bit writeAllowed of a virtual page
+/*!  Set the disk address of a range of virtual pages, which are
 
-//   \param virtualPage : the virtual page
+//   neither in physical memory nor in the swap yet (bits valid, swap
 
-*/
+//   and io are cleared).
 
-//----------------------------------------------------------------------
+//   \param firstPage : the first virtual page of the range
 
-void TranslationTable::clearBitWriteAllowed(int virtualPage) {
-
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
-
-  pageTable[virtualPage].writeAllowed = false;
-
-}
-
-
-
-//----------------------------------------------------------------------
+//   \param numPages : the number of pages of the range
 
-//   TranslationTable::getBitWriteAllowed
+//   \param addrDisk : the address in the executable file of the first
 
-/*!  Get the bit writeAllowed of a virtual page
+//                     page, or -1 for anonymous pages
 
-//   \param virtualPage : the virtual page
+//   \param step : the increment of the address from one page to the
 
-//   \return value of the bit writeAllowed
+//                 next (the page size, or 0 for anonymous pages)
 
 */
 
 //----------------------------------------------------------------------
 
-bool TranslationTable::getBitWriteAllowed(int virtualPage) {
-
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
-
-  return pageTable[virtualPage].writeAllowed;
-
-}
-
-
-
-void TranslationTable::setBitU(int virtualPage) {
-
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
+void TranslationTable::setRangeAddrDisk(int firstPage, int numPages,
 
-  pageTable[virtualPage].U = true;
-
-}
+					int addrDisk, int step) {
 
+  for (int i = firstPage; i < firstPage + numPages; i++) {
 
+    PageTableEntry *entry = allocEntry(i);
 
-void TranslationTable::clearBitU(int virtualPage) {
+    entry->valid = false;
 
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
+    entry->swap = false;
 
-  pageTable[virtualPage].U = false;
+    entry->io = false;
 
-}
+    entry->addrDisk = addrDisk;
 
-bool TranslationTable::getBitU(int virtualPage) {
+    addrDisk += step;
 
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
+    ShootDown(i);
 
-  return pageTable[virtualPage].U;
-
-}
-
-
-
-void TranslationTable::setBitM(int virtualPage) {
-
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
-
-  pageTable[virtualPage].M = true;
-
-}
-
-
-
-void TranslationTable::clearBitM(int virtualPage) {
-
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
-
-  pageTable[virtualPage].M = false;
-
-}
-
-bool TranslationTable::getBitM(int virtualPage) {
-
-  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
-
-  return   pageTable[virtualPage].M;
+  }
 
 }
 
@@ -620,8 +316,12 @@ PageTableEntry::PageTableEntry()
 
   swap=false;
 
+  io=false;
+
   addrDisk = -1;
 
+  physicalPage = -1;
+
   readAllowed=false;
 
   writeAllowed=false;
@@ -630,5 +330,9 @@ PageTableEntry::PageTableEntry()
 
   M = false;
 
+  cow = false;
+
+  prefetched = false;
+
 }
 
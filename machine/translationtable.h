@@ -46,6 +46,16 @@ enum TranslationMode { SingleLevel, DualLevel };
 
 
 
+//! log2 of the number of entries of a second-level table (DualLevel mode)
+
+#define SECOND_LEVEL_SHIFT 8
+
+//! Number of entries of a second-level table (DualLevel mode)
+
+#define SECOND_LEVEL_SIZE (1 << SECOND_LEVEL_SHIFT)
+
+
+
 /*! \brief Defines the data structures used for address translation
 
 // 
@@ -64,15 +74,25 @@ class TranslationTable {
 
 
 
-  int getMaxNumPages(); //!< Get the maximum number of pages
+  int getMaxNumPages() { return maxNumPages; }
+
+                        //!< Get the maximum number of pages
 
                         //!< that can be translated by this translation table
 
+
+
+  int getAsid() { return asid; } //!< Get the address space identifier
+
+                                 //!< tagging the TLB entries of this table
+
  
 
   // Methods to get/set specific fields of a page table
 
-  // entry corresponding to a particular virtual page
+  // entry corresponding to a particular virtual page (inline, see
+
+  // below)
 
   void setPhysicalPage(int virtualPage, int physicalPage);
 
@@ -140,6 +160,32 @@ class TranslationTable {
 
   bool getBitM(int virtualPage);
 
+  void setBitCow(int virtualPage);
+
+  void clearBitCow(int virtualPage);
+
+  bool getBitCow(int virtualPage);
+
+  void setBitPrefetched(int virtualPage);
+
+  void clearBitPrefetched(int virtualPage);
+
+
+
+  // Methods to initialize the entries of a range of virtual pages
+
+  // at once, when an address space is built
+
+  void setRangeAccess(int firstPage, int numPages,
+
+		      bool readAllowed, bool writeAllowed);
+
+  void setRangeAddrDisk(int firstPage, int numPages,
+
+			int addrDisk, int step);
+
+
+
  private:
 
 
@@ -150,10 +196,66 @@ class TranslationTable {
 
 
 
-  // Page table entries
+  // Type of the table, set from the configuration
+
+  TranslationMode mode;
+
+
+
+  // Page table entries (SingleLevel mode)
 
   PageTableEntry *pageTable;
 
+
+
+  // First-level table (DualLevel mode): pointers to the second-level
+
+  // tables, NULL for the tables not allocated yet
+
+  PageTableEntry **directory;
+
+  int directorySize;
+
+
+
+  // Entry of all the pages of unallocated second-level tables
+
+  static PageTableEntry unmappedEntry;
+
+
+
+  // The MMU reads and updates the entries directly
+
+  friend class MMU;
+
+
+
+  // Entry of a virtual page, to read it or to modify it
+
+  PageTableEntry *getEntry(int virtualPage);
+
+  PageTableEntry *allocEntry(int virtualPage);
+
+
+
+  // Allocate the second-level table of a virtual page (DualLevel mode)
+
+  PageTableEntry *allocSecondLevel(int virtualPage);
+
+
+
+  // Address space identifier, unique to this table
+
+  int asid;
+
+  static int nextAsid;
+
+
+
+  // Invalidate the TLB entry of a page whose translation changes
+
+  void ShootDown(int virtualPage);
+
 };
 
 
@@ -170,6 +272,12 @@ class TranslationTable {
 
 // read-only) and some bits for usage information (use and dirty).
 
+//
+
+// The bits are packed in a single word with the physical page number,
+
+// so that an entry takes 8 bytes.
+
 */
 
 
@@ -192,7 +300,7 @@ class PageTableEntry {
 
     memory. */
 
-  bool valid;
+  bool valid : 1;
 
   
 
@@ -200,7 +308,7 @@ class PageTableEntry {
 
     This bit is set by hardware (MMU) and reset by software (page replacement) */
 
-  bool U;
+  bool U : 1;
 
 
 
@@ -210,7 +318,7 @@ class PageTableEntry {
 
    by software when the page is copied back to disk */
 
-  bool M;
+  bool M : 1;
 
 
 
@@ -224,25 +332,51 @@ class PageTableEntry {
 
      to the page leads to an AddressErrorException */
 
-  bool readAllowed;  /*!< Allows program to read the page contents */
+  bool readAllowed : 1;  /*!< Allows program to read the page contents */
 
-  bool writeAllowed; /*!< Allows program to modify the page contents */
+  bool writeAllowed : 1; /*!< Allows program to modify the page contents */
 
-  
 
-  /*! The page number in real memory (relative to the
 
-    start of "mainMemory"). Relevant when valid is true only ! */
+  /*! If this bit is set, the page must be load from swap.
 
-  int physicalPage;
+    If not, the page must be load from executable file.*/
 
+  bool swap : 1;
 
 
-  /*! If this bit is set, the page must be load from swap.
 
-    If not, the page must be load from executable file.*/
+  /*! This bit is set by the system every time the
+
+    page is occupied in a input-output.  */
+
+  bool io : 1;
+
+
 
-  bool swap;
+  /*! If this bit is set, the page is shared with another process
+
+    since a Fork, and writeAllowed is cleared: the first write to the
+
+    page makes a private copy of it, and allows writing again. */
+
+  bool cow : 1;
+
+
+
+  /*! This bit is set when the page is read ahead by the page fault
+
+    manager, and cleared on its first access (for statistics). */
+
+  bool prefetched : 1;
+
+  
+
+  /*! The page number in real memory (relative to the
+
+    start of "mainMemory"). Relevant when valid is true only ! */
+
+  int physicalPage : 23;
 
 
 
@@ -256,15 +390,213 @@ class PageTableEntry {
 
   int addrDisk;
 
+};
 
 
-  /*! This bit is set by the system every time the
 
-    page is occupied in a input-output.  */
+//----------------------------------------------------------------------
 
-  bool io;
+// Inline methods of TranslationTable, used by the MMU on each memory
 
-};
+// access
+
+//----------------------------------------------------------------------
+
+
+
+//! Get the entry of a virtual page, to read it. In DualLevel mode,
+
+//! the pages of unallocated second-level tables share an unmapped entry
+
+inline PageTableEntry *TranslationTable::getEntry(int virtualPage) {
+
+  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
+
+  if (mode == SingleLevel)
+
+    return &pageTable[virtualPage];
+
+  PageTableEntry *table = directory[virtualPage >> SECOND_LEVEL_SHIFT];
+
+  if (table == NULL)
+
+    return &unmappedEntry;
+
+  return &table[virtualPage & (SECOND_LEVEL_SIZE - 1)];
+
+}
+
+
+
+//! Get the entry of a virtual page, to modify it. In DualLevel mode,
+
+//! its second-level table is allocated if needed
+
+inline PageTableEntry *TranslationTable::allocEntry(int virtualPage) {
+
+  ASSERT ((virtualPage >= 0) && (virtualPage < maxNumPages));
+
+  if (mode == SingleLevel)
+
+    return &pageTable[virtualPage];
+
+  PageTableEntry *table = directory[virtualPage >> SECOND_LEVEL_SHIFT];
+
+  if (table == NULL)
+
+    table = allocSecondLevel(virtualPage);
+
+  return &table[virtualPage & (SECOND_LEVEL_SIZE - 1)];
+
+}
+
+
+
+// Changes of the translation of a page, of its access rights or of
+
+// its U/M bits invalidate its TLB entry (see mmu.h)
+
+
+
+inline void TranslationTable::setPhysicalPage(int virtualPage, int physicalPage)
+
+{ allocEntry(virtualPage)->physicalPage = physicalPage; ShootDown(virtualPage); }
+
+inline int TranslationTable::getPhysicalPage(int virtualPage)
+
+{ return getEntry(virtualPage)->physicalPage; }
+
+
+
+inline void TranslationTable::setAddrDisk(int virtualPage, int addrDisk)
+
+{ allocEntry(virtualPage)->addrDisk = addrDisk; }
+
+inline int TranslationTable::getAddrDisk(int virtualPage)
+
+{ return getEntry(virtualPage)->addrDisk; }
+
+
+
+inline void TranslationTable::setBitIo(int virtualPage)
+
+{ allocEntry(virtualPage)->io = true; }
+
+inline void TranslationTable::clearBitIo(int virtualPage)
+
+{ allocEntry(virtualPage)->io = false; }
+
+inline bool TranslationTable::getBitIo(int virtualPage)
+
+{ return getEntry(virtualPage)->io; }
+
+
+
+inline void TranslationTable::setBitValid(int virtualPage)
+
+{ allocEntry(virtualPage)->valid = true; }
+
+inline void TranslationTable::clearBitValid(int virtualPage)
+
+{ allocEntry(virtualPage)->valid = false; ShootDown(virtualPage); }
+
+inline bool TranslationTable::getBitValid(int virtualPage)
+
+{ return getEntry(virtualPage)->valid; }
+
+
+
+inline void TranslationTable::setBitSwap(int virtualPage)
+
+{ allocEntry(virtualPage)->swap = true; }
+
+inline void TranslationTable::clearBitSwap(int virtualPage)
+
+{ allocEntry(virtualPage)->swap = false; }
+
+inline bool TranslationTable::getBitSwap(int virtualPage)
+
+{ return getEntry(virtualPage)->swap; }
+
+
+
+inline void TranslationTable::setBitReadAllowed(int virtualPage)
+
+{ allocEntry(virtualPage)->readAllowed = true; }
+
+inline void TranslationTable::clearBitReadAllowed(int virtualPage)
+
+{ allocEntry(virtualPage)->readAllowed = false; ShootDown(virtualPage); }
+
+inline bool TranslationTable::getBitReadAllowed(int virtualPage)
+
+{ return getEntry(virtualPage)->readAllowed; }
+
+
+
+inline void TranslationTable::setBitWriteAllowed(int virtualPage)
+
+{ allocEntry(virtualPage)->writeAllowed = true; }
+
+inline void TranslationTable::clearBitWriteAllowed(int virtualPage)
+
+{ allocEntry(virtualPage)->writeAllowed = false; ShootDown(virtualPage); }
+
+inline bool TranslationTable::getBitWriteAllowed(int virtualPage)
+
+{ return getEntry(virtualPage)->writeAllowed; }
+
+
+
+inline void TranslationTable::setBitU(int virtualPage)
+
+{ allocEntry(virtualPage)->U = true; }
+
+inline void TranslationTable::clearBitU(int virtualPage)
+
+{ allocEntry(virtualPage)->U = false; ShootDown(virtualPage); }
+
+inline bool TranslationTable::getBitU(int virtualPage)
+
+{ return getEntry(virtualPage)->U; }
+
+
+
+inline void TranslationTable::setBitM(int virtualPage)
+
+{ allocEntry(virtualPage)->M = true; }
+
+inline void TranslationTable::clearBitM(int virtualPage)
+
+{ allocEntry(virtualPage)->M = false; ShootDown(virtualPage); }
+
+inline bool TranslationTable::getBitM(int virtualPage)
+
+{ return getEntry(virtualPage)->M; }
+
+
+
+inline void TranslationTable::setBitCow(int virtualPage)
+
+{ allocEntry(virtualPage)->cow = true; }
+
+inline void TranslationTable::clearBitCow(int virtualPage)
+
+{ allocEntry(virtualPage)->cow = false; }
+
+inline bool TranslationTable::getBitCow(int virtualPage)
+
+{ return getEntry(virtualPage)->cow; }
+
+
+
+inline void TranslationTable::setBitPrefetched(int virtualPage)
+
+{ allocEntry(virtualPage)->prefetched = true; }
+
+inline void TranslationTable::clearBitPrefetched(int virtualPage)
+
+{ allocEntry(virtualPage)->prefetched = false; }
 
  
 
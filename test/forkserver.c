@@ -0,0 +1,112 @@
+/* forkserver.c
+
+ *    Server-style use of Fork: a worker process is forked for each
+
+ *    request. The table of the server is shared by all the workers,
+
+ *    each of them getting a private copy of the pages it writes
+
+ *    (copy-on-write).
+
+ *
+
+//  Copyright (c) 1999-2000 INSA de Rennes.
+
+//  All rights reserved.  
+
+//  See copyright_insa.h for copyright notice and limitation 
+
+//  of liability and disclaimer of warranty provisions.
+
+ */
+
+
+
+#include "userlib/syscall.h"
+
+#include "userlib/libnachos.h"
+
+
+
+#define Requests	8
+
+#define Size		512	/* words of the table (16 pages of 128 bytes) */
+
+
+
+int table[Size];
+
+
+
+/* Handle a request in a worker: only the first page of the table is
+
+ * modified, the other ones stay shared with the server */
+
+void
+
+serve(int request)
+
+{
+
+  int i, sum = 0;
+
+
+
+  table[0] = request;
+
+  for (i = 0; i < Size; i++)
+
+    sum += table[i];
+
+  n_printf("request %d: %d\n", request, sum);
+
+}
+
+
+
+int
+
+main()
+
+{
+
+  int i, request;
+
+  ThreadId workers[Requests];
+
+
+
+  for (i = 0; i < Size; i++)
+
+    table[i] = i;
+
+
+
+  for (request = 0; request < Requests; request++) {
+
+    workers[request] = Fork();
+
+    if (workers[request] == 0) {
+
+      serve(request);
+
+      Exit(0);
+
+    }
+
+  }
+
+  for (request = 0; request < Requests; request++)
+
+    Join(workers[request]);
+
+
+
+  /* The table of the server is unchanged */
+
+  n_printf("server: %d\n", table[0]);
+
+  return 0;
+
+}
+
@@ -0,0 +1,84 @@
+/* membench.c
+
+ *    Microbenchmark of the address translation of the MMU.
+
+ *
+
+ *    Repeatedly reads and writes an array spanning a few tens of
+
+ *    pages, with a unit stride and with a stride of one page, so that
+
+ *    nearly all the simulated time is spent in memory accesses. The
+
+ *    host time per memory access is measured by "make bench_mmu".
+
+ *
+
+//  Copyright (c) 1999-2000 INSA de Rennes.
+
+//  All rights reserved.  
+
+//  See copyright_insa.h for copyright notice and limitation 
+
+//  of liability and disclaimer of warranty provisions.
+
+ */
+
+
+
+#include "userlib/syscall.h"
+
+
+
+#define Size	768	/* words of the array (24 pages of 128 bytes),
+
+			 * small enough to stay in physical memory
+
+			 */
+
+#define Stride	32	/* words per page */
+
+#define Passes	400
+
+
+
+int A[Size];
+
+
+
+int
+
+main()
+
+{
+
+    int pass, i, j, sum = 0;
+
+
+
+    for (pass = 0; pass < Passes; pass++) {
+
+	for (i = 0; i < Size; i++)		/* sequential accesses */
+
+	    A[i] = A[i] + pass;
+
+
+
+	for (j = 0; j < Stride; j++)		/* one access per page */
+
+	    for (i = j; i < Size; i += Stride)
+
+		sum += A[i];
+
+    }
+
+
+
+    Exit(sum);
+
+
+
+    return 0;
+
+}
+
@@ -0,0 +1,114 @@
+/* mmapscan.c
+
+ *    Test of the memory-mapped files.
+
+ *
+
+ *    Writes a data file, maps it and scans it through the mapping
+
+ *    instead of reading it, doubles every value in place, and unmaps
+
+ *    it. The file is then read again with Read, to check that the
+
+ *    modified pages were written back.
+
+ *
+
+//  Copyright (c) 1999-2000 INSA de Rennes.
+
+//  All rights reserved.  
+
+//  See copyright_insa.h for copyright notice and limitation 
+
+//  of liability and disclaimer of warranty provisions.
+
+ */
+
+
+
+#include "userlib/syscall.h"
+
+#include "userlib/libnachos.h"
+
+
+
+#define Size	1024	/* words of the file (32 pages of 128 bytes) */
+
+
+
+int Buffer[Size];
+
+
+
+int
+
+main()
+
+{
+
+    OpenFileId f;
+
+    int *mapped;
+
+    int i, sum = 0, errors = 0;
+
+
+
+    for (i = 0; i < Size; i++)
+
+	Buffer[i] = i;
+
+    Create("/mmapdata", Size * sizeof(int));
+
+    f = Open("/mmapdata");
+
+    Write((char *)Buffer, Size * sizeof(int), f);
+
+
+
+    mapped = (int *)Mmap(f, Size * sizeof(int));
+
+    if ((int)mapped == -1) {
+
+	n_printf("Mmap failed\n");
+
+	Exit(-1);
+
+    }
+
+    for (i = 0; i < Size; i++) {	/* paging-driven reads */
+
+	sum += mapped[i];
+
+	mapped[i] = 2 * mapped[i];
+
+    }
+
+    Munmap((int)mapped);
+
+
+
+    Seek(0, f);
+
+    Read((char *)Buffer, Size * sizeof(int), f);
+
+    Close(f);
+
+    for (i = 0; i < Size; i++)
+
+	if (Buffer[i] != 2 * i)
+
+	    errors++;
+
+    n_printf("sum %d, %d errors\n", sum, errors);
+
+
+
+    Exit(errors);
+
+
+
+    return 0;
+
+}
+
@@ -644,3 +644,45 @@ Mmap:	addiu $2,$0,SC_MMAP
 
 	.end Mmap
 
+
+
+	.globl Fork
+
+	.ent	Fork
+
+Fork:	addiu $2,$0,SC_FORK
+
+	syscall
+
+	j	$31
+
+	.end Fork
+
+
+
+	.globl Munmap
+
+	.ent	Munmap
+
+Munmap:	addiu $2,$0,SC_MUNMAP
+
+	syscall
+
+	j	$31
+
+	.end Munmap
+
+
+
+	.globl Sync
+
+	.ent	Sync
+
+Sync:	addiu $2,$0,SC_SYNC
+
+	syscall
+
+	j	$31
+
+	.end Sync
+
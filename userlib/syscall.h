@@ -126,6 +126,12 @@
 
 #define SC_MMAP		 33 
 
+#define SC_FORK		 34 
+
+#define SC_MUNMAP	 35 
+
+#define SC_SYNC		 36 
+
 
 
 #ifndef IN_ASM
@@ -196,6 +202,20 @@ ThreadId Exec(char *name);
 
 
 
+/* Create a copy of the current process, running the same program from
+
+ * the same point. The pages of the process are shared by both processes
+
+ * until one of them writes them (copy-on-write). Return the master thread
+
+ * identifier of the new process, or 0 in the new process.
+
+ */
+
+ThreadId Fork();
+
+
+
 /* Create a new thread in the current process
 
  * Return thread identifier
@@ -362,6 +382,16 @@ void FSList();
 
 
 
+/* Write back to the disk the headers of the open files and the
+
+   sectors modified in the buffer cache of the file system.
+
+*/
+
+void Sync();
+
+
+
 /******************************************************************/
 
 /* User-level synchronization operations :  */
@@ -530,12 +560,32 @@ int TtyReceive(char *mess,int length);
 
 /* Map an opened file in memory. Size is the size to be mapped in bytes.
 
+   Returns the address of the mapping, or -1 on error. The pages are
+
+   read from the file when they are first accessed, and the modified
+
+   ones are written back to the file, at the latest when the file is
+
+   unmapped or the process exits. The file is not extended: the part of
+
+   the mapping beyond its end is only zero-filled memory.
+
 */
 
 int Mmap(OpenFileId f, int size);
 
 
 
+/* Unmap a file mapped at address addr by Mmap, writing back its
+
+   modified pages. Returns 0, or -1 if no file is mapped there.
+
+*/
+
+int Munmap(int addr);
+
+
+
 #endif // IN_ASM
 
 #endif // SYSCALL_H
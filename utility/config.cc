@@ -82,6 +82,8 @@ Config::Config(char *configname) {
 
   MaxVirtPages=1024;
 
+  TranslationTableMode=SingleLevel;
+
   UserStackSize=8*1024;
 
   ProcessorFrequency = 100;
@@ -114,6 +116,36 @@ Config::Config(char *configname) {
 
   ACIA=ACIA_NONE;
 
+  ExecutionEngine=ENGINE_INTERPRETER;
+
+  TLBSize=64;
+
+  TLBAssociativity=4;
+
+  FaultAround=1;
+
+  PrefetchMax=8;
+
+  PageReplacement=POLICY_CLOCK;
+
+  WorkingSetWindow=1000000;
+
+  LowWatermark=2;
+
+  HighWatermark=4;
+
+  CompressedSwapSize=0;
+
+  DiskScheduling=DISK_SCHED_CLOOK;
+
+  BufferCacheSize=128;
+
+  BufferCachePolicy=CACHE_2Q;
+
+  NameCacheSize=64;
+
+  PrintMachineState=false;
+
   strcpy(ProgramToRun,"");
 
 
@@ -490,6 +522,298 @@ Config::Config(char *configname) {
 
       
 
+      if (strcmp(commande,"ExecutionEngine") == 0){
+
+	char engine[LINE_LENGTH];
+
+	if (sscanf(ligne," %s = %s ",commande,engine)==2) {
+
+	  if (strcmp(engine,"Interpreter")==0)
+
+	    ExecutionEngine = ENGINE_INTERPRETER;
+
+	  else if (strcmp(engine,"Threaded")==0)
+
+	    ExecutionEngine = ENGINE_THREADED;
+
+	  else fail(nblignes,configname,ligne);
+
+	}
+
+	else fail(nblignes,configname,ligne);
+
+	continue;
+
+      }
+
+
+
+      if (strcmp(commande,"TranslationMode") == 0){
+
+	char mode[LINE_LENGTH];
+
+	if (sscanf(ligne," %s = %s ",commande,mode)==2) {
+
+	  if (strcmp(mode,"SingleLevel")==0)
+
+	    TranslationTableMode = SingleLevel;
+
+	  else if (strcmp(mode,"DualLevel")==0)
+
+	    TranslationTableMode = DualLevel;
+
+	  else fail(nblignes,configname,ligne);
+
+	}
+
+	else fail(nblignes,configname,ligne);
+
+	continue;
+
+      }
+
+
+
+      if (strcmp(commande,"TLBSize") == 0){
+
+	if(sscanf(ligne," %s = %i ",commande,&TLBSize)!=2)
+
+	  fail(nblignes,configname,ligne);
+
+	continue;
+
+      }
+
+
+
+      if (strcmp(commande,"TLBAssociativity") == 0){
+
+	if(sscanf(ligne," %s = %i ",commande,&TLBAssociativity)!=2)
+
+	  fail(nblignes,configname,ligne);
+
+	continue;
+
+      }
+
+
+
+      if (strcmp(commande,"FaultAround") == 0){
+
+	if(sscanf(ligne," %s = %i ",commande,&FaultAround)!=2)
+
+	  fail(nblignes,configname,ligne);
+
+	continue;
+
+      }
+
+
+
+      if (strcmp(commande,"PrefetchMax") == 0){
+
+	if(sscanf(ligne," %s = %i ",commande,&PrefetchMax)!=2)
+
+	  fail(nblignes,configname,ligne);
+
+	continue;
+
+      }
+
+
+
+      if (strcmp(commande,"PageReplacement") == 0){
+
+	char policy[LINE_LENGTH];
+
+	if (sscanf(ligne," %s = %s ",commande,policy)==2) {
+
+	  if (strcmp(policy,"Clock")==0)
+
+	    PageReplacement = POLICY_CLOCK;
+
+	  else if (strcmp(policy,"TwoHandedClock")==0)
+
+	    PageReplacement = POLICY_TWO_HANDED_CLOCK;
+
+	  else if (strcmp(policy,"WSClock")==0)
+
+	    PageReplacement = POLICY_WSCLOCK;
+
+	  else if (strcmp(policy,"Aging")==0)
+
+	    PageReplacement = POLICY_AGING;
+
+	  else if (strcmp(policy,"ClockPro")==0)
+
+	    PageReplacement = POLICY_CLOCK_PRO;
+
+	  else fail(nblignes,configname,ligne);
+
+	}
+
+	else fail(nblignes,configname,ligne);
+
+	continue;
+
+      }
+
+
+
+      if (strcmp(commande,"WorkingSetWindow") == 0){
+
+	if(sscanf(ligne," %s = %i ",commande,&WorkingSetWindow)!=2)
+
+	  fail(nblignes,configname,ligne);
+
+	continue;
+
+      }
+
+
+
+      if (strcmp(commande,"LowWatermark") == 0){
+
+	if(sscanf(ligne," %s = %i ",commande,&LowWatermark)!=2)
+
+	  fail(nblignes,configname,ligne);
+
+	continue;
+
+      }
+
+
+
+      if (strcmp(commande,"HighWatermark") == 0){
+
+	if(sscanf(ligne," %s = %i ",commande,&HighWatermark)!=2)
+
+	  fail(nblignes,configname,ligne);
+
+	continue;
+
+      }
+
+
+
+      if (strcmp(commande,"CompressedSwapSize") == 0){
+
+	if(sscanf(ligne," %s = %i ",commande,&CompressedSwapSize)!=2)
+
+	  fail(nblignes,configname,ligne);
+
+	continue;
+
+      }
+
+
+
+      if (strcmp(commande,"DiskScheduling") == 0){
+
+	char policy[LINE_LENGTH];
+
+	if (sscanf(ligne," %s = %s ",commande,policy)==2) {
+
+	  if (strcmp(policy,"FIFO")==0)
+
+	    DiskScheduling = DISK_SCHED_FIFO;
+
+	  else if (strcmp(policy,"SSTF")==0)
+
+	    DiskScheduling = DISK_SCHED_SSTF;
+
+	  else if (strcmp(policy,"CLOOK")==0)
+
+	    DiskScheduling = DISK_SCHED_CLOOK;
+
+	  else fail(nblignes,configname,ligne);
+
+	}
+
+	else fail(nblignes,configname,ligne);
+
+	continue;
+
+      }
+
+
+
+      if (strcmp(commande,"BufferCacheSize") == 0){
+
+	if(sscanf(ligne," %s = %i ",commande,&BufferCacheSize)!=2)
+
+	  fail(nblignes,configname,ligne);
+
+	continue;
+
+      }
+
+
+
+      if (strcmp(commande,"NameCacheSize") == 0){
+
+	if(sscanf(ligne," %s = %i ",commande,&NameCacheSize)!=2)
+
+	  fail(nblignes,configname,ligne);
+
+	continue;
+
+      }
+
+
+
+      if (strcmp(commande,"BufferCachePolicy") == 0){
+
+	char policy[LINE_LENGTH];
+
+	if (sscanf(ligne," %s = %s ",commande,policy)==2) {
+
+	  if (strcmp(policy,"LRU")==0)
+
+	    BufferCachePolicy = CACHE_LRU;
+
+	  else if (strcmp(policy,"2Q")==0)
+
+	    BufferCachePolicy = CACHE_2Q;
+
+	  else fail(nblignes,configname,ligne);
+
+	}
+
+	else fail(nblignes,configname,ligne);
+
+	continue;
+
+      }
+
+
+
+      if (strcmp(commande,"PrintMachineState") == 0){
+
+	int v;
+
+	if(sscanf(ligne," %s = %i ",commande,&v)==2)
+
+	  {
+
+	    if (v==0)
+
+	      PrintMachineState = false;
+
+	    else 
+
+	      PrintMachineState = true;
+
+	  }
+
+	else fail(nblignes,configname,ligne);
+
+	continue;
+
+      }
+
+      
+
       if (strcmp(commande,"NumPortLoc") == 0){
 
 	if(sscanf(ligne," %s = %i ",commande,&NumPortLoc)!=2)
@@ -558,6 +882,76 @@ Config::Config(char *configname) {
 
 
 
+  // Check that the TLB is made of sets of the same size
+
+  if ((TLBSize < 0) || (TLBAssociativity <= 0)
+
+      || (TLBSize % TLBAssociativity != 0)) {
+
+    printf("Configuration error : TLBSize should be a multiple of TLBAssociativity, exiting\n");
+
+    exit(-1);
+
+  }
+
+
+
+  // The read-ahead window starts with the fault-around one
+
+  if ((FaultAround < 0) || (PrefetchMax < FaultAround)) {
+
+    printf("Configuration error : PrefetchMax should be at least FaultAround, exiting\n");
+
+    exit(-1);
+
+  }
+
+
+
+  // The page-out daemon needs room to give the pages back
+
+  if ((LowWatermark < 0) || (HighWatermark < LowWatermark)
+
+      || (HighWatermark >= NumPhysPages)) {
+
+    printf("Configuration error : HighWatermark should be between LowWatermark and NumPhysPages, exiting\n");
+
+    exit(-1);
+
+  }
+
+
+
+  if (CompressedSwapSize < 0) {
+
+    printf("Configuration error : CompressedSwapSize should not be negative, exiting\n");
+
+    exit(-1);
+
+  }
+
+
+
+  if (BufferCacheSize < 0) {
+
+    printf("Configuration error : BufferCacheSize should not be negative, exiting\n");
+
+    exit(-1);
+
+  }
+
+
+
+  if (NameCacheSize < 0) {
+
+    printf("Configuration error : NameCacheSize should not be negative, exiting\n");
+
+    exit(-1);
+
+  }
+
+
+
   NumDirect = ((SectorSize - 4 * sizeof(int)) / sizeof(int));
 
   //MaxFileSize = (NumDirect * SectorSize);
@@ -46,6 +46,46 @@
 
 
 
+/* Execution engines of the MIPS simulator */
+
+#define ENGINE_INTERPRETER 0
+
+#define ENGINE_THREADED 1
+
+
+
+/* Page replacement policies of the physical memory manager */
+
+#define POLICY_CLOCK 0
+
+#define POLICY_TWO_HANDED_CLOCK 1
+
+#define POLICY_WSCLOCK 2
+
+#define POLICY_AGING 3
+
+#define POLICY_CLOCK_PRO 4
+
+
+
+/* Request scheduling of the disk drivers */
+
+#define DISK_SCHED_FIFO 0
+
+#define DISK_SCHED_SSTF 1
+
+#define DISK_SCHED_CLOOK 2
+
+
+
+/* Replacement policies of the file system buffer cache */
+
+#define CACHE_LRU 0
+
+#define CACHE_2Q 1
+
+
+
 /*! \brief Defines Nachos hardware and software configuration 
 
 *
@@ -82,6 +122,30 @@ class Config {
 
   int ACIA;                //!< Use ACIA if USE_ACIA, don't use it if ACIA_NONE
 
+  int ExecutionEngine;     //!< ENGINE_INTERPRETER or ENGINE_THREADED
+
+  int TLBSize;             //!< Number of entries of the MMU software TLB (0 to disable it)
+
+  int TLBAssociativity;    //!< Number of entries of each set of the TLB
+
+  int FaultAround;         //!< Number of pages following a faulting page of the executable read with it (0 to disable it)
+
+  int PrefetchMax;         //!< Maximum number of pages read ahead on sequential page faults
+
+  int PageReplacement;     //!< POLICY_CLOCK, POLICY_TWO_HANDED_CLOCK, POLICY_WSCLOCK, POLICY_AGING or POLICY_CLOCK_PRO
+
+  int WorkingSetWindow;    //!< Cycles without reference after which a page leaves the working set (WSClock)
+
+  int LowWatermark;        //!< Number of free pages under which the page-out daemon is woken up (0 to disable it)
+
+  int HighWatermark;       //!< Number of free pages up to which the page-out daemon evicts pages
+
+  int CompressedSwapSize;  //!< Bytes of memory keeping swapped pages compressed (0 to disable it)
+
+
+
+  int DiskScheduling;      //!< DISK_SCHED_FIFO, DISK_SCHED_SSTF or DISK_SCHED_CLOOK
+
 
 
   // File system configuration
@@ -96,6 +160,12 @@ class Config {
 
   int DirectoryFileSize;   //!< Length of a directory file
 
+  int BufferCacheSize;     //!< Number of sectors of the buffer cache (0 to disable it)
+
+  int BufferCachePolicy;   //!< CACHE_LRU or CACHE_2Q
+
+  int NameCacheSize;       //!< Number of directory entries cached (0 to disable it)
+
   int NumPortLoc;	   //!< Local ACIA's port number
 
   int NumPortDist;	   //!< Distant ACIA's port number
@@ -108,6 +178,8 @@ class Config {
 
   int MaxVirtPages;        //!< Maximum number of virtual pages in each address space (used to allocate the page table)
 
+  TranslationMode TranslationTableMode; //!< SingleLevel (linear page tables) or DualLevel (two-level page tables, allocated on demand)
+
   bool TimeSharing;        //!< Use the time sharing mode if true (1) - not implemented in the base code
 
   int MagicNumber;         //!< 0x456789ab
@@ -128,6 +200,8 @@ class Config {
 
   bool PrintStat;          //!< Print the statistics if true
 
+  bool PrintMachineState;  //!< Print the registers and a checksum of the memory at the end if true
+
   bool FormatDisk;         //!< Format the disk if true
 
   bool Print;              //!< Print  FileToPrint if true
@@ -24,6 +24,8 @@
 
 #include "utility/stats.h"
 
+#include "machine/machine.h"
+
 
 
 //----------------------------------------------------------------------
@@ -46,6 +48,40 @@ Statistics::Statistics()
 
   idleTicks=totalTicks=0;
 
+  numFPUSwitches=0;
+
+  numCleanDrops=numDirtyWritebacks=0;
+
+  numSwapReads=numSwapWrites=0;
+
+  numPageOutWakeups=numPageOutPages=0;
+
+  numContendedFaults=numPageWaits=0;
+
+  numSharedPages=0;
+
+  numCowCopies=numCowReuses=0;
+
+  numPrefetchedPages=numPrefetchHits=0;
+
+  numMappedReads=numMappedWrites=0;
+
+  numCompressedStores=numCompressedHits=0;
+
+  numCompressedSpills=numCompressedRejects=0;
+
+  compressedInput=compressedOutput=0;
+
+  numDiskSubmits=maxDiskQueueDepth=numDiskRequests=numDiskSectors=0;
+
+  diskQueueDepth=diskSeekTracks=0;
+
+  numCacheHits=numCacheMisses=numCacheDirtied=numCacheWritebacks=0;
+
+  numHeaderHits=numHeaderFetches=numHeaderWritebacks=0;
+
+  numNameHits=numNameNegativeHits=numNameMisses=0;
+
 }
 
 
@@ -120,6 +156,110 @@ Statistics::Print()
 
 	 cycle_to_nano(totalTicks,g_cfg->ProcessorFrequency));
 
+  printf("   Lazy FPU switches : %d\n", numFPUSwitches);
+
+  printf("   Page evictions : %d clean drops, %d dirty writebacks\n",
+
+	 numCleanDrops, numDirtyWritebacks);
+
+  printf("   Swap Input/Output : reads %d , writes %d \n",
+
+	 numSwapReads, numSwapWrites);
+
+  printf("   Page-out daemon : %d wakeups, %d pages evicted\n",
+
+	 numPageOutWakeups, numPageOutPages);
+
+  printf("   Page waits : %d contended faults, %d sleeps\n",
+
+	 numContendedFaults, numPageWaits);
+
+  printf("   Shared text pages : %d mappings\n", numSharedPages);
+
+  printf("   Copy-on-write : %d copies, %d pages reused\n",
+
+	 numCowCopies, numCowReuses);
+
+  printf("   Prefetch : %d pages read ahead, %d of them used\n",
+
+	 numPrefetchedPages, numPrefetchHits);
+
+  printf("   Memory-mapped files : %d pages read, %d pages written back\n",
+
+	 numMappedReads, numMappedWrites);
+
+  printf("   Compressed swap : %d pages stored, ratio %.2f, %d hits, %d spills, %d incompressible\n",
+
+	 numCompressedStores,
+
+	 (compressedOutput > 0) ? (double)compressedInput / compressedOutput : 0.0,
+
+	 numCompressedHits, numCompressedSpills, numCompressedRejects);
+
+  printf("   Disk scheduling : %d requests, %.2f sectors per request, average seek %.2f tracks, average queue depth %.2f (max %d)\n",
+
+	 numDiskRequests,
+
+	 (numDiskRequests > 0) ? (double)numDiskSectors / numDiskRequests : 0.0,
+
+	 (numDiskRequests > 0) ? (double)diskSeekTracks / numDiskRequests : 0.0,
+
+	 (numDiskSubmits > 0) ? (double)diskQueueDepth / numDiskSubmits : 0.0,
+
+	 maxDiskQueueDepth);
+
+  printf("   Buffer cache : %d hits, %d misses (hit ratio %.2f), %d blocks dirtied, %d written back\n",
+
+	 numCacheHits, numCacheMisses,
+
+	 (numCacheHits + numCacheMisses > 0)
+
+	 ? (double)numCacheHits / (numCacheHits + numCacheMisses) : 0.0,
+
+	 numCacheDirtied, numCacheWritebacks);
+
+  printf("   File headers : %d opens, %d found in core, %d fetched, %d written back\n",
+
+	 numHeaderHits + numHeaderFetches, numHeaderHits, numHeaderFetches,
+
+	 numHeaderWritebacks);
+
+  printf("   Name cache : %d hits (%d negative), %d misses (hit ratio %.2f)\n",
+
+	 numNameHits, numNameNegativeHits, numNameMisses,
+
+	 (numNameHits + numNameMisses > 0)
+
+	 ? (double)numNameHits / (numNameHits + numNameMisses) : 0.0);
+
+  if (g_machine != NULL)
+
+    printf("   Decoded instructions cache : %llu hits, %llu misses, %llu page invalidations, %llu basic blocks\n",
+
+	   (unsigned long long)g_machine->decodeCache->getHits(),
+
+	   (unsigned long long)g_machine->decodeCache->getMisses(),
+
+	   (unsigned long long)g_machine->decodeCache->getInvalidations(),
+
+	   (unsigned long long)g_machine->decodeCache->getBlocks());
+
+  if ((g_machine != NULL) && (g_cfg->TLBSize > 0)) {
+
+    uint64_t hits = g_machine->mmu->getTLBHits();
+
+    uint64_t lookups = hits + g_machine->mmu->getTLBMisses();
+
+    printf("   TLB : %llu hits, %llu misses, hit rate %.2f%%\n",
+
+	   (unsigned long long)hits,
+
+	   (unsigned long long)(lookups - hits),
+
+	   (lookups == 0) ? 0.0 : (100.0 * hits) / lookups);
+
+  }
+
 }
 
 
@@ -204,6 +344,8 @@ ProcessStat::ProcessStat(char *processName)
 
   numMemoryAccess=numPageFaults=0;
 
+  maxResidentPages=0;
+
   systemTicks = userTicks = 0;
 
 }
@@ -342,6 +484,8 @@ void ProcessStat::Print(void)
 
 	   numMemoryAccess, numPageFaults);
 
+  printf("   Resident set : %d pages at most\n", maxResidentPages);
+
 
 
     printf("------------------------------------------------------------\n");
@@ -58,6 +58,82 @@ class Statistics {
 
   Time idleTicks;           //!< Time spent idle (no thread to run)
 
+  int numFPUSwitches;       //!< Number of lazy floating point context switches
+
+  int numCleanDrops;        //!< Evicted pages not written back (clean)
+
+  int numDirtyWritebacks;   //!< Evicted pages written to the swap (dirty)
+
+  int numSwapReads;         //!< Pages read from the swap area
+
+  int numSwapWrites;        //!< Pages written to the swap area
+
+  int numPageOutWakeups;    //!< Number of times the page-out daemon was woken up
+
+  int numPageOutPages;      //!< Pages evicted by the page-out daemon
+
+  int numContendedFaults;   //!< Page faults on a page being transferred
+
+  int numPageWaits;         //!< Sleeps waiting for a transfer or an unlock
+
+  int numSharedPages;       //!< Page faults served by a shared read-only page
+
+  int numCowCopies;         //!< Pages copied on a write after a Fork
+
+  int numCowReuses;         //!< Pages written after a Fork, no longer shared
+
+  int numPrefetchedPages;   //!< Pages read ahead by the page fault manager
+
+  int numPrefetchHits;      //!< Pages read ahead referenced before their eviction
+
+  int numMappedReads;       //!< Pages read from memory-mapped files
+
+  int numMappedWrites;      //!< Pages written back to memory-mapped files
+
+  int numCompressedStores;  //!< Pages kept in the compressed swap pool
+
+  long long compressedInput; //!< Bytes of the pages stored in the pool
+
+  long long compressedOutput; //!< Bytes of these pages once compressed
+
+  int numCompressedHits;    //!< Swap reads served by the compressed pool
+
+  int numCompressedSpills;  //!< Pages spilled from the pool to the swap disk
+
+  int numCompressedRejects; //!< Pages written to the swap disk, not compressible
+
+  int numDiskSubmits;       //!< Requests submitted to the disk drivers
+
+  long long diskQueueDepth; //!< Sum of the queue depths seen by these requests
+
+  int maxDiskQueueDepth;    //!< Deepest queue of a disk driver
+
+  int numDiskRequests;      //!< Requests sent to the disks
+
+  int numDiskSectors;       //!< Sectors transferred by these requests
+
+  long long diskSeekTracks; //!< Tracks crossed by the disk heads
+
+  int numCacheHits;         //!< Sectors read from the buffer cache
+
+  int numCacheMisses;       //!< Sectors read from the disk by the buffer cache
+
+  int numCacheDirtied;      //!< Clean blocks of the buffer cache made dirty
+
+  int numCacheWritebacks;   //!< Dirty blocks written back to the disk
+
+  int numHeaderHits;        //!< Opens finding the file header in core
+
+  int numHeaderFetches;     //!< File headers fetched by the header table
+
+  int numHeaderWritebacks;  //!< Modified file headers written back
+
+  int numNameHits;          //!< Path components found in the name cache
+
+  int numNameNegativeHits;  //!< Among them, names known to be missing
+
+  int numNameMisses;        //!< Path components looked up in the directories
+
                           
 
  public:
@@ -88,6 +164,78 @@ class Statistics {
 
   void incrIdleTicks (Time val) {idleTicks +=val;}
 
+  void incrFPUSwitches(void) {numFPUSwitches++;}
+
+  void incrCleanDrops(void) {numCleanDrops++;}
+
+  void incrDirtyWritebacks(void) {numDirtyWritebacks++;}
+
+  void incrSwapReads(void) {numSwapReads++;}
+
+  void incrSwapWrites(void) {numSwapWrites++;}
+
+  void incrPageOutWakeups(void) {numPageOutWakeups++;}
+
+  void incrPageOutPages(void) {numPageOutPages++;}
+
+  void incrContendedFaults(void) {numContendedFaults++;}
+
+  void incrPageWaits(void) {numPageWaits++;}
+
+  void incrSharedPages(void) {numSharedPages++;}
+
+  void incrCowCopies(void) {numCowCopies++;}
+
+  void incrCowReuses(void) {numCowReuses++;}
+
+  void incrPrefetchedPages(void) {numPrefetchedPages++;}
+
+  void incrPrefetchHits(void) {numPrefetchHits++;}
+
+  void incrMappedReads(int n) {numMappedReads += n;}
+
+  void incrMappedWrites(void) {numMappedWrites++;}
+
+  void incrCompressedStores(int in, int out)
+
+    {numCompressedStores++; compressedInput += in; compressedOutput += out;}
+
+  void incrCompressedHits(void) {numCompressedHits++;}
+
+  void incrCompressedSpills(void) {numCompressedSpills++;}
+
+  void incrCompressedRejects(void) {numCompressedRejects++;}
+
+  void incrDiskSubmits(int depth)
+
+    {numDiskSubmits++; diskQueueDepth += depth;
+
+     if (depth > maxDiskQueueDepth) maxDiskQueueDepth = depth;}
+
+  void incrDiskRequests(int tracks, int sectors)
+
+    {numDiskRequests++; diskSeekTracks += tracks; numDiskSectors += sectors;}
+
+  void incrCacheHits(void) {numCacheHits++;}
+
+  void incrCacheMisses(int n) {numCacheMisses += n;}
+
+  void incrCacheDirtied(void) {numCacheDirtied++;}
+
+  void incrCacheWritebacks(void) {numCacheWritebacks++;}
+
+  void incrHeaderHits(void) {numHeaderHits++;}
+
+  void incrHeaderFetches(void) {numHeaderFetches++;}
+
+  void incrHeaderWritebacks(void) {numHeaderWritebacks++;}
+
+  void incrNameHits(bool negative)
+
+    {numNameHits++; if (negative) numNameNegativeHits++;}
+
+  void incrNameMisses(void) {numNameMisses++;}
+
 };
 
 
@@ -136,6 +284,8 @@ private:
 
   int numPageFaults;            //!< number of virtual memory page faults
 
+  int maxResidentPages;         //!< largest resident set size (in pages)
+
 public:
 
   ProcessStat(char *name);      /* initialises everything to zero and 
@@ -154,6 +304,8 @@ public:
 
   void incrPageFault(void) {numPageFaults++;}
 
+  void updateResidentPages(int n) {if (n > maxResidentPages) maxResidentPages = n;}
+
   void incrNumCharWritten(void) {numConsoleCharsWritten++;}
 
   void incrNumCharRead(void) {numConsoleCharsRead++;}
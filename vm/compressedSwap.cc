@@ -0,0 +1,552 @@
+//-----------------------------------------------------------------
+
+/*! \file compressedSwap.cc
+
+//  \brief In-memory pool of compressed swap pages
+
+*/
+
+//
+
+//  Copyright (c) 1999-2000 INSA de Rennes.
+
+//  All rights reserved.
+
+//  See copyright_insa.h for copyright notice and limitation
+
+//  of liability and disclaimer of warranty provisions.
+
+//-----------------------------------------------------------------
+
+
+
+#include "vm/compressedSwap.h"
+
+#include "drivers/drvDisk.h"
+
+#include "kernel/system.h"
+
+#include "utility/stats.h"
+
+
+
+#include <string.h>
+
+
+
+//! Number of entries of the dictionary of recently seen words
+
+#define DICT_SIZE 16
+
+
+
+//! Low-order bits of a word which may differ from a dictionary entry
+
+#define LOW_BITS 10
+
+
+
+//! Tags of the compressed words
+
+enum { TAG_ZERO, TAG_EXACT, TAG_PARTIAL, TAG_MISS };
+
+
+
+//-----------------------------------------------------------------
+
+// CompressedSwap::CompressedSwap
+
+//
+
+/*! Create an empty pool
+
+//
+
+//  \param poolSize is the size of the pool, in bytes
+
+//  \param disk is the swap disk the pages spill to
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+CompressedSwap::CompressedSwap(int poolSize, DriverDisk *disk) {
+
+
+
+    ASSERT(g_cfg->PageSize % sizeof(uint32_t) == 0);
+
+    budget = poolSize;
+
+    used = 0;
+
+    swap_disk = disk;
+
+    data = new uint8_t*[NUM_SECTORS];
+
+    size = new int[NUM_SECTORS];
+
+    for (int i = 0; i < NUM_SECTORS; i++) {
+
+        data[i] = NULL;
+
+        size[i] = 0;
+
+    }
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// CompressedSwap::~CompressedSwap
+
+//
+
+/*! Delete the pool and the pages it holds
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+CompressedSwap::~CompressedSwap() {
+
+
+
+    for (int i = 0; i < NUM_SECTORS; i++)
+
+        delete [] data[i];
+
+    delete [] data;
+
+    delete [] size;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// CompressedSwap::Store
+
+//
+
+/*! Keep the page of a swap sector in the pool, compressed, making
+
+//  room for it by spilling the least recently used pages. The
+
+//  previous page of the sector is forgotten.
+
+//
+
+//  \param num_sector is the sector of the page in the swap area
+
+//  \param page is the contents of the page
+
+//  \return true if the page is in the pool, false if it does not
+
+//    compress or does not fit in the pool, and must be written to
+
+//    the disk
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+bool CompressedSwap::Store(int num_sector, char *page) {
+
+
+
+    uint8_t buffer[g_cfg->PageSize + g_cfg->PageSize / 4];
+
+    int n = Compress(page, buffer);
+
+
+
+    Drop(num_sector);
+
+    if ((n >= g_cfg->PageSize) || (n > budget)) {
+
+        g_stats->incrCompressedRejects();
+
+        return false;
+
+    }
+
+
+
+    // Spilling a page waits for the disk: the pool may change meanwhile
+
+    while ((used + n > budget) && !lru.IsEmpty())
+
+        Spill();
+
+
+
+    data[num_sector] = new uint8_t[n];
+
+    memcpy(data[num_sector], buffer, n);
+
+    size[num_sector] = n;
+
+    used += n;
+
+    lru.Append((void *)(int64_t)num_sector);
+
+    g_stats->incrCompressedStores(g_cfg->PageSize, n);
+
+    return true;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// CompressedSwap::Load
+
+//
+
+/*! Copy the page of a swap sector from the pool. The page stays in
+
+//  the pool: the page in memory is clean, and is not written back
+
+//  when it is evicted again.
+
+//
+
+//  \param num_sector is the sector of the page in the swap area
+
+//  \param page is the buffer where to put the page
+
+//  \return true if the page was in the pool
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+bool CompressedSwap::Load(int num_sector, char *page) {
+
+
+
+    if (data[num_sector] == NULL)
+
+        return false;
+
+    Decompress(data[num_sector], page);
+
+    lru.RemoveItem((void *)(int64_t)num_sector);
+
+    lru.Append((void *)(int64_t)num_sector);
+
+    g_stats->incrCompressedHits();
+
+    return true;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// CompressedSwap::Drop
+
+//
+
+/*! Forget the page of a swap sector, if it is in the pool
+
+//
+
+//  \param num_sector is the sector of the page in the swap area
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+void CompressedSwap::Drop(int num_sector) {
+
+
+
+    if (data[num_sector] == NULL)
+
+        return;
+
+    lru.RemoveItem((void *)(int64_t)num_sector);
+
+    delete [] data[num_sector];
+
+    data[num_sector] = NULL;
+
+    used -= size[num_sector];
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// CompressedSwap::Spill
+
+//
+
+/*! Write the least recently used page of the pool to its sector of
+
+//  the swap disk. The page leaves the pool before the write: the
+
+//  reads of the sector queue up behind it on the disk.
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+void CompressedSwap::Spill() {
+
+
+
+    char page[g_cfg->PageSize];
+
+    int num_sector = (int)(int64_t)lru.Remove();
+
+
+
+    Decompress(data[num_sector], page);
+
+    delete [] data[num_sector];
+
+    data[num_sector] = NULL;
+
+    used -= size[num_sector];
+
+    DEBUG('v', (char *)"Spilling compressed swap page %i\n", num_sector);
+
+    swap_disk->WriteSector(num_sector, page);
+
+    g_stats->incrSwapWrites();
+
+    g_stats->incrCompressedSpills();
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// CompressedSwap::DictIndex
+
+//
+
+/*! Dictionary entry of a word, found from its high-order bits so
+
+//  that the partial matches land on the same entry
+
+//
+
+//  \param word is the word
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+int CompressedSwap::DictIndex(uint32_t word) {
+
+
+
+    return ((word >> LOW_BITS) * 2654435761u) >> 28;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// CompressedSwap::Compress
+
+//
+
+/*! Compress a page: the two-bit tags of all the words come first,
+
+//  followed by the bytes of the words which are not zero: the
+
+//  dictionary entry of an exact match, the entry and the low-order
+
+//  bits of a partial match, or the four bytes of a miss.
+
+//
+
+//  \param page is the page to compress
+
+//  \param out is the buffer of the compressed page, large enough
+
+//    for a page of misses
+
+//  \return the size of the compressed page
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+int CompressedSwap::Compress(char *page, uint8_t *out) {
+
+
+
+    uint32_t dict[DICT_SIZE];
+
+    int numWords = g_cfg->PageSize / sizeof(uint32_t);
+
+    int n = (numWords + 3) / 4;
+
+
+
+    memset(dict, 0, sizeof(dict));
+
+    memset(out, 0, n);
+
+    for (int i = 0; i < numWords; i++) {
+
+        uint32_t word;
+
+        int tag;
+
+        memcpy(&word, page + i * sizeof(uint32_t), sizeof(uint32_t));
+
+        int index = DictIndex(word);
+
+        if (word == 0)
+
+            tag = TAG_ZERO;
+
+        else if (dict[index] == word) {
+
+            tag = TAG_EXACT;
+
+            out[n++] = index;
+
+        } else if ((dict[index] >> LOW_BITS) == (word >> LOW_BITS)) {
+
+            tag = TAG_PARTIAL;
+
+            out[n++] = index;
+
+            out[n++] = word & 0xff;
+
+            out[n++] = (word >> 8) & ((1 << (LOW_BITS - 8)) - 1);
+
+            dict[index] = word;
+
+        } else {
+
+            tag = TAG_MISS;
+
+            memcpy(out + n, &word, sizeof(uint32_t));
+
+            n += sizeof(uint32_t);
+
+            dict[index] = word;
+
+        }
+
+        out[i / 4] |= tag << (2 * (i % 4));
+
+    }
+
+    return n;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// CompressedSwap::Decompress
+
+//
+
+/*! Rebuild a page compressed by Compress
+
+//
+
+//  \param in is the compressed page
+
+//  \param page is the buffer where to put the page
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+void CompressedSwap::Decompress(uint8_t *in, char *page) {
+
+
+
+    uint32_t dict[DICT_SIZE];
+
+    int numWords = g_cfg->PageSize / sizeof(uint32_t);
+
+    int n = (numWords + 3) / 4;
+
+
+
+    memset(dict, 0, sizeof(dict));
+
+    for (int i = 0; i < numWords; i++) {
+
+        uint32_t word = 0;
+
+        int index;
+
+        switch ((in[i / 4] >> (2 * (i % 4))) & 3) {
+
+        case TAG_EXACT:
+
+            word = dict[in[n++]];
+
+            break;
+
+        case TAG_PARTIAL:
+
+            index = in[n++];
+
+            word = (dict[index] & ~((1u << LOW_BITS) - 1)) | in[n] | (in[n + 1] << 8);
+
+            n += 2;
+
+            dict[index] = word;
+
+            break;
+
+        case TAG_MISS:
+
+            memcpy(&word, in + n, sizeof(uint32_t));
+
+            n += sizeof(uint32_t);
+
+            dict[DictIndex(word)] = word;
+
+            break;
+
+        }
+
+        memcpy(page + i * sizeof(uint32_t), &word, sizeof(uint32_t));
+
+    }
+
+}
+
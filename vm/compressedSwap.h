@@ -0,0 +1,148 @@
+//-----------------------------------------------------------------
+
+/*! \file compressedSwap.h
+
+    \brief In-memory pool of compressed swap pages
+
+
+
+    The pages written to the swap area are first compressed into a
+
+    pool of the kernel memory, whose size is set by the
+
+    CompressedSwapSize entry of the configuration file (0 to disable
+
+    it). A page read back from the swap area is copied from the pool
+
+    when it is there, without any disk access. When the pool is full,
+
+    its least recently used pages spill to their sector of the swap
+
+    disk. A page that does not compress is written to the disk
+
+    directly.
+
+
+
+    The pages are compressed word by word, in the way of the WK
+
+    algorithms: a word is zero, equal to a recently seen word, equal
+
+    to it but for its 10 low-order bits, or stored as is. A two-bit
+
+    tag tells which, and the recently seen words are kept in a small
+
+    direct-mapped dictionary, rebuilt the same way by the
+
+    decompression.
+
+
+
+    Copyright (c) 1999-2000 INSA de Rennes.
+
+    All rights reserved.
+
+    See copyright_insa.h for copyright notice and limitation
+
+    of liability and disclaimer of warranty provisions.
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+#ifndef __COMPRESSEDSWAP_H
+
+#define __COMPRESSEDSWAP_H
+
+
+
+#include "utility/list.h"
+
+
+
+class DriverDisk;
+
+
+
+//-----------------------------------------------------------------
+
+/*! \brief Pool of compressed pages in front of the swap disk
+
+
+
+   The pages of the pool are identified by the sector of the swap
+
+   area allocated to them by the swap manager, which stays theirs
+
+   when they spill to the disk.
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+class CompressedSwap {
+
+public:
+
+  CompressedSwap(int poolSize, DriverDisk *disk);
+
+  ~CompressedSwap();
+
+
+
+  //! Keeps a page of a swap sector in the pool, false if it must be
+
+  //! written to the disk
+
+  bool Store(int num_sector, char *page);
+
+
+
+  //! Copies a page of a swap sector from the pool, false if it is
+
+  //! not in the pool
+
+  bool Load(int num_sector, char *page);
+
+
+
+  //! Forgets the page of a swap sector, released or overwritten
+
+  void Drop(int num_sector);
+
+
+
+private:
+
+  void Spill();				//!< Writes the least recently used page to the disk
+
+  int Compress(char *page, uint8_t *out); //!< Compresses a page, returns its size
+
+  void Decompress(uint8_t *in, char *page); //!< Rebuilds a compressed page
+
+  static int DictIndex(uint32_t word);	//!< Dictionary entry of a word
+
+
+
+  int budget;				//!< Size of the pool, in bytes
+
+  int used;				//!< Bytes of the compressed pages in the pool
+
+  DriverDisk *swap_disk;		//!< Disk the pages spill to
+
+  uint8_t **data;			//!< Compressed page of each swap sector, NULL if none
+
+  int *size;				//!< Size of the compressed page of each sector
+
+  Listint lru;				//!< Sectors in the pool, least recently used first
+
+};
+
+
+
+#endif // __COMPRESSEDSWAP_H
+
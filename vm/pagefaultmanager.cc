@@ -73,48 +73,265 @@ ExceptionType PageFaultManager::PageFault(uint32_t virtualPage)
 {
     
 
-    auto translationTable = g_machine->mmu->translationTable;
+    AddrSpace *addrspace = g_current_thread->GetProcessOwner()->addrspace;
+
+    auto translationTable = addrspace->translationTable;
 
 
     auto oldInt = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+    // The page is being transferred by another thread: sleep until the
+    // end of the transfer
+    if (translationTable->getBitIo(virtualPage))
+        g_stats->incrContendedFaults();
     while (translationTable->getBitIo(virtualPage))
-    {
+        g_physical_mem_manager->WaitPageIo(addrspace, virtualPage);
+    // Another thread of the process may have loaded the page while
+    // this one was waiting: it must not be mapped twice
+    if (translationTable->getBitValid(virtualPage)) {
         g_machine->interrupt->SetStatus(oldInt);
-        g_current_thread->Yield();
-        oldInt = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+        return NO_EXCEPTION;
     }
     translationTable->setBitIo(virtualPage);
     g_machine->interrupt->SetStatus(oldInt);
 
     auto inSwap = translationTable->getBitSwap(virtualPage);
     int diskAddr = translationTable->getAddrDisk(virtualPage);
-    int np = g_physical_mem_manager->AddPhysicalToVirtualMapping(g_current_thread->GetProcessOwner()->addrspace, virtualPage);
-    g_machine->mmu->translationTable->setPhysicalPage(virtualPage, np);
+    auto exec_file = g_current_thread->GetProcessOwner()->exec_file;
+    // Pages of a memory-mapped file are read from it instead of the
+    // executable file
+    OpenFile *mapped = addrspace->findMappedFile(virtualPage * g_cfg->PageSize);
+    // Read-only pages of the executable file are shared between the
+    // processes running the same program
+    bool shared = (!inSwap) && (diskAddr != -1) && (mapped == NULL)
+                  && (!translationTable->getBitWriteAllowed(virtualPage))
+                  && (!translationTable->getBitCow(virtualPage));
+    if (shared) {
+        int sp = g_physical_mem_manager->MapSharedPage(addrspace, virtualPage,
+                                                       exec_file->GetSector(), diskAddr);
+        if (sp != -1) {
+            translationTable->setPhysicalPage(virtualPage, sp);
+            translationTable->clearBitM(virtualPage);
+            translationTable->setBitValid(virtualPage);
+            g_physical_mem_manager->EndPageIo(addrspace, virtualPage);
+            return NO_EXCEPTION;
+        }
+    }
+
+    int np = g_physical_mem_manager->AddPhysicalToVirtualMapping(addrspace, virtualPage);
+    if (shared)
+        g_physical_mem_manager->ShareTextPage(np, exec_file->GetSector(), diskAddr);
+    translationTable->setPhysicalPage(virtualPage, np);
     
 
     if (inSwap) {
-        // Page load from the swap
-        while (diskAddr == -1) {
-            g_current_thread->Yield();
-            diskAddr = translationTable->getAddrDisk(virtualPage);
-        }
+        // Page load from the swap. The swap sector is set with the swap
+        // bit, before the end of the transfer we waited for
+        ASSERT(diskAddr != -1);
         char buff[g_cfg->PageSize];
         g_swap_manager->GetPageSwap(diskAddr, buff);
         memcpy(&(g_machine->mainMemory[translationTable->getPhysicalPage(virtualPage) * g_cfg->PageSize]), buff, g_cfg->PageSize);
-        translationTable->clearBitSwap(virtualPage);
-        g_swap_manager->ReleasePageSwap(diskAddr);
+        // The page keeps its swap slot: as long as it is not modified,
+        // it does not need to be written back when evicted
     } else if ((!inSwap) && (diskAddr == -1)) {
         // anonymous page
         bzero(&(g_machine->mainMemory[translationTable->getPhysicalPage(virtualPage) * g_cfg->PageSize]), g_cfg->PageSize);
 
     } else {
-        // load from the exec file
-        auto exec_file = g_current_thread->GetProcessOwner()->exec_file;
-        exec_file->ReadAt((char *)&(g_machine->mainMemory[translationTable->getPhysicalPage(virtualPage) * g_cfg->PageSize]), g_cfg->PageSize, diskAddr);
+        // load from the exec file or the mapped file, with the
+        // following pages
+        LoadFromFile(addrspace, (mapped != NULL) ? mapped : exec_file,
+                     virtualPage, diskAddr, shared);
     }
-    translationTable->clearBitIo(virtualPage);
+    translationTable->clearBitM(virtualPage);
+    translationTable->clearBitPrefetched(virtualPage);
+    translationTable->setBitValid(virtualPage);
+    g_physical_mem_manager->EndPageIo(addrspace, virtualPage);
+
+    // The page can now be chosen for replacement
+    g_physical_mem_manager->UnlockPage(np);
+
+    return NO_EXCEPTION;
+}
+
+
+
+// void LoadFromFile(AddrSpace *addrspace, OpenFile *file,
+
+//                   uint32_t virtualPage, int diskAddr, bool shared)
+
+/*!
 
-    g_machine->mmu->translationTable->setBitValid(virtualPage);
+//	Reads a page from the executable file or a memory-mapped file
+
+//      into its physical page, together with the following pages of
+
+//      the same section or mapping that are not in memory yet, in a
+
+//      single read. The window grows on
+
+//      sequential faults, and the pages read ahead are only given
+
+//      free physical pages, at most half of them.
+
+//
+
+//	\param addrspace the address space of the faulting process
+
+//	\param file the executable file, or the file mapped at this page
+
+//	\param virtualPage the virtual page subject to the page fault,
+
+//	  already mapped to its (locked) physical page
+
+//	\param diskAddr the offset of the page in the file
+
+//	\param shared true for a read-only page, shared between processes
+
+*/
 
+void PageFaultManager::LoadFromFile(AddrSpace *addrspace, OpenFile *file,
+                                    uint32_t virtualPage, int diskAddr, bool shared)
+{
+    auto translationTable = addrspace->translationTable;
+    OpenFile *mapped = addrspace->findMappedFile(virtualPage * g_cfg->PageSize);
+    int pageSize = g_cfg->PageSize;
+
+    // Sequential faults double the read-ahead window
+    if ((int)virtualPage == addrspace->nextFaultPage) {
+        addrspace->prefetchWindow *= 2;
+        if (addrspace->prefetchWindow == 0)
+            addrspace->prefetchWindow = 1;
+        if (addrspace->prefetchWindow > g_cfg->PrefetchMax)
+            addrspace->prefetchWindow = g_cfg->PrefetchMax;
+    } else
+        addrspace->prefetchWindow = g_cfg->FaultAround;
+    int window = addrspace->prefetchWindow;
+    if (window > g_physical_mem_manager->GetNumFreePages() / 2)
+        window = g_physical_mem_manager->GetNumFreePages() / 2;
+
+    // Map the following pages with the same rights, stored just after
+    // this one in the file, which are not in memory yet. No page is
+    // evicted here: the mapping does not yield the processor
+    int frames[window + 1];
+    int nbPages = 1;
+    frames[0] = translationTable->getPhysicalPage(virtualPage);
+    while (nbPages <= window) {
+        int vp = virtualPage + nbPages;
+        if ((vp >= translationTable->getMaxNumPages())
+            || translationTable->getBitValid(vp)
+            || translationTable->getBitIo(vp)
+            || translationTable->getBitSwap(vp)
+            || (translationTable->getAddrDisk(vp) != diskAddr + nbPages * pageSize)
+            || (translationTable->getBitReadAllowed(vp) != translationTable->getBitReadAllowed(virtualPage))
+            || (translationTable->getBitWriteAllowed(vp) != translationTable->getBitWriteAllowed(virtualPage))
+            || (translationTable->getBitCow(vp) != translationTable->getBitCow(virtualPage))
+            || (addrspace->findMappedFile(vp * pageSize) != mapped))
+            break;
+        // Another process already has it, it is mapped on its fault
+        if (shared && g_physical_mem_manager->IsTextPageResident(file->GetSector(),
+                                                                 diskAddr + nbPages * pageSize))
+            break;
+        int np = g_physical_mem_manager->AddPrefetchMapping(addrspace, vp);
+        if (np == -1)
+            break;
+        translationTable->setBitIo(vp);
+        if (shared)
+            g_physical_mem_manager->ShareTextPage(np, file->GetSector(),
+                                                  diskAddr + nbPages * pageSize);
+        translationTable->setPhysicalPage(vp, np);
+        frames[nbPages++] = np;
+    }
+
+    // A single read for all the pages. The end of a page beyond the
+    // end of the file is filled with zeroes
+    if (nbPages == 1) {
+        bzero(&(g_machine->mainMemory[frames[0] * pageSize]), pageSize);
+        file->ReadAt((char *)&(g_machine->mainMemory[frames[0] * pageSize]), pageSize, diskAddr);
+    } else {
+        char *buffer = new char[nbPages * pageSize];
+        bzero(buffer, nbPages * pageSize);
+        file->ReadAt(buffer, nbPages * pageSize, diskAddr);
+        for (int i = 0; i < nbPages; i++)
+            memcpy(&(g_machine->mainMemory[frames[i] * pageSize]), &buffer[i * pageSize], pageSize);
+        delete [] buffer;
+    }
+
+    // The pages read ahead are ready, the faulting one is completed by
+    // the caller
+    for (int i = 1; i < nbPages; i++) {
+        translationTable->clearBitM(virtualPage + i);
+        translationTable->clearBitU(virtualPage + i);
+        translationTable->setBitPrefetched(virtualPage + i);
+        translationTable->setBitValid(virtualPage + i);
+        g_physical_mem_manager->EndPageIo(addrspace, virtualPage + i);
+        g_physical_mem_manager->UnlockPage(frames[i]);
+    }
+    addrspace->nextFaultPage = virtualPage + nbPages;
+    if (mapped != NULL)
+        g_stats->incrMappedReads(nbPages);
+}
+
+
+
+// ExceptionType CopyOnWrite(uint32_t virtualPage)
+
+/*!
+
+//	This method is called by the Memory Management Unit on a write to
+
+//      a read-only page. If the page is shared with another process
+
+//      since a Fork, the faulting process gets a private copy of it,
+
+//      which it can write. The page is kept as is if the other
+
+//      processes do not use it anymore.
+
+//
+
+//	\param virtualPage the virtual page subject to the write access
+
+//	\return NO_EXCEPTION if the page can now be written,
+
+//	  READONLY_EXCEPTION if the page is really read-only
+
+*/
+
+ExceptionType PageFaultManager::CopyOnWrite(uint32_t virtualPage)
+{
+    AddrSpace *addrspace = g_current_thread->GetProcessOwner()->addrspace;
+    auto translationTable = addrspace->translationTable;
+
+    if (!translationTable->getBitCow(virtualPage))
+        return READONLY_EXCEPTION;
+
+    // Wait until the page is in memory and is not being transferred
+    while (true) {
+        if (!translationTable->getBitValid(virtualPage))
+            PageFault(virtualPage);
+        // Another thread of the process already made the copy
+        if (!translationTable->getBitCow(virtualPage))
+            return NO_EXCEPTION;
+        if (translationTable->getBitIo(virtualPage))
+            g_physical_mem_manager->WaitPageIo(addrspace, virtualPage);
+        else if (translationTable->getBitValid(virtualPage)
+                 && g_physical_mem_manager->IsLocked(translationTable->getPhysicalPage(virtualPage)))
+            g_physical_mem_manager->WaitPageUnlocked(translationTable->getPhysicalPage(virtualPage));
+        else if (translationTable->getBitValid(virtualPage))
+            break;
+    }
+    translationTable->setBitIo(virtualPage);
+    int oldPage = translationTable->getPhysicalPage(virtualPage);
+    int np = g_physical_mem_manager->UnsharePage(oldPage, addrspace, virtualPage);
+    if (np == oldPage)
+        g_stats->incrCowReuses();
+    else
+        g_stats->incrCowCopies();
+    translationTable->setPhysicalPage(virtualPage, np);
+    translationTable->clearBitCow(virtualPage);
+    translationTable->setBitWriteAllowed(virtualPage);
+    translationTable->setBitValid(virtualPage);
+    g_physical_mem_manager->EndPageIo(addrspace, virtualPage);
+    g_physical_mem_manager->UnlockPage(np);
     return NO_EXCEPTION;
 }
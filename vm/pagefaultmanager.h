@@ -28,12 +28,36 @@
 
 
 
+class AddrSpace;
+
+class OpenFile;
+
+
+
 /*! \brief Defines the page fault manager
 
    This object manages the page fault of the simulated MIPS processor 
 
    for the Nachos kernel.
 
+
+
+   A page loaded from the executable file is read together with the
+
+   following pages of the same section (fault-around). When the
+
+   faults of an address space follow each other, the number of pages
+
+   read ahead doubles at each fault, up to PrefetchMax. Pages are only
+
+   read ahead in free physical pages.
+
+
+
+   The pages of a memory-mapped file are read from this file in the
+
+   same way (see AddrSpace::Mmap).
+
 */
 
 class PageFaultManager {
@@ -52,6 +76,18 @@ public:
 
   ExceptionType PageFault(uint32_t virtualPage); //!< Page faut handler
 
+
+
+  ExceptionType CopyOnWrite(uint32_t virtualPage); //!< Write to a page shared since a Fork
+
+
+
+private:
+
+  void LoadFromFile(AddrSpace *addrspace, OpenFile *file, uint32_t virtualPage,
+
+                    int diskAddr, bool shared); //!< Read a page and the following ones from the executable or a mapped file
+
 };
 
 
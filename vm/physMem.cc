@@ -20,8 +20,14 @@
 
 #include "vm/physMem.h"
 
+#include "kernel/msgerror.h"
+
+#include "kernel/scheduler.h"
+
 #include <unistd.h>
 
+#include <string.h>
+
 //-----------------------------------------------------------------
 
 // PhysicalMemManager::PhysicalMemManager
@@ -48,10 +54,32 @@ PhysicalMemManager::PhysicalMemManager() {
 
         tpr[i].owner = NULL;
 
+        tpr[i].refCount = 0;
+
+        tpr[i].sharers = NULL;
+
+        tpr[i].textKey = -1;
+
         free_page_list.Append((void*)i);
     }
 
-    i_clock = -1;
+    numFreePages = g_cfg->NumPhysPages;
+
+    policy = NewReplacementPolicy(this);
+
+    pageOutWakeup = NULL;
+
+    pageOutRunning = false;
+
+    numFrameWaiters = 0;
+
+    numWaitQueues = g_cfg->NumPhysPages;
+
+    waitQueues = new struct waiter_c*[numWaitQueues];
+
+    for (i = 0; i < numWaitQueues; i++)
+
+        waitQueues[i] = NULL;
 }
 
 PhysicalMemManager::~PhysicalMemManager() {
@@ -64,6 +92,14 @@ PhysicalMemManager::~PhysicalMemManager() {
     // Delete physical page table
 
     delete[] tpr;
+
+    delete policy;
+
+    delete[] waitQueues;
+
+    // The page-out daemon never ends: it still waits on pageOutWakeup,
+
+    // which is not deleted
 }
 
 //-----------------------------------------------------------------
@@ -72,7 +108,9 @@ PhysicalMemManager::~PhysicalMemManager() {
 
 //
 
-/*! This method releases an unused physical page by clearing the
+/*! This method deletes a mapping of a physical page. When the page
+
+//  is not mapped anymore, it is released by clearing the
 
 //  corresponding bit in the page_flags bitmap structure, and adding
 
@@ -80,30 +118,91 @@ PhysicalMemManager::~PhysicalMemManager() {
 
 //
 
-//  \param num_page is the number of the real page to free
+//  \param num_page is the number of the real page
+
+//  \param owner is the address space of the mapping to delete
+
+//  \param virtualPage is the virtual page of the mapping to delete
 
 */
 
 //-----------------------------------------------------------------
 
-void PhysicalMemManager::RemovePhysicalToVirtualMapping(long num_page) {
+void PhysicalMemManager::RemovePhysicalToVirtualMapping(long num_page, AddrSpace* owner, int virtualPage) {
+
     // Check that the page is not already free
 
     ASSERT(!tpr[num_page].free);
 
+    // Unmap the page from the address space
+
+    if (owner->translationTable != NULL)
+
+        owner->translationTable->clearBitValid(virtualPage);
+
+    UnlinkMapping(num_page, owner, virtualPage);
+
+    // Other processes still use the page
+
+    if (tpr[num_page].refCount > 0)
+
+        return;
+
+    if (tpr[num_page].textKey != -1) {
+
+        textFrames.erase(tpr[num_page].textKey);
+
+        tpr[num_page].textKey = -1;
+
+    }
+
+    ReleaseFrame(num_page);
+}
+
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::ReleaseFrame
+
+//
+
+/*! Puts a physical page that is not mapped anymore in the free list
+
+//
+
+//  \param numPage is the number of the real page
+
+*/
+
+//-----------------------------------------------------------------
+
+void PhysicalMemManager::ReleaseFrame(long numPage) {
+
     // Update the physical page table entry
 
-    tpr[num_page].free = true;
+    tpr[numPage].free = true;
 
-    tpr[num_page].locked = false;
+    tpr[numPage].locked = false;
+
+    tpr[numPage].owner = NULL;
+
+    policy->PageFreed(numPage);
+
+    WakeUp(NULL, numPage);
 
-    if (tpr[num_page].owner->translationTable != NULL)
+    if (numFrameWaiters > 0)
 
-        tpr[num_page].owner->translationTable->clearBitValid(tpr[num_page].virtualPage);
+        WakeUp(NULL, ANY_FRAME);
+
+    // Forget the decoded instructions of the page
+    g_machine->decodeCache->InvalidatePage(numPage);
 
     // Insert the page in the free list
 
-    free_page_list.Prepend((void*)num_page);
+    free_page_list.Prepend((void*)numPage);
+
+    numFreePages++;
 }
 
 //-----------------------------------------------------------------
@@ -138,6 +237,12 @@ void PhysicalMemManager::UnlockPage(long num_page) {
     ASSERT(tpr[num_page].free == false);
 
     tpr[num_page].locked = false;
+
+    WakeUp(NULL, num_page);
+
+    if (numFrameWaiters > 0)
+
+        WakeUp(NULL, ANY_FRAME);
 }
 
 //-----------------------------------------------------------------
@@ -208,22 +313,82 @@ int PhysicalMemManager::AddPhysicalToVirtualMapping(AddrSpace* owner, int virtua
     return (0);
 #endif
 #ifdef ETUDIANTS_TP
-    int np = FindFreePage();
-    if (np != -1) {
-        ASSERT(tpr[np].locked == false);
-        tpr[np].locked = true;
-    } else {
+    int np;
+    // The page-out daemon may free pages while this thread waits
+    while (true) {
+        np = FindFreePage();
+        if (np != -1) {
+            ASSERT(tpr[np].locked == false);
+            tpr[np].locked = true;
+            break;
+        }
         np = EvictPage();
+        if (np != -1)
+            break;
+        // All the pages are locked: let the page faults in progress end
+        WaitAnyFrame();
     }
     tpr[np].owner = owner;
     tpr[np].virtualPage = virtualPage;
     tpr[np].free = false;
-
-    tpr[np].locked = false;
+    tpr[np].refCount = 1;
+    tpr[np].sharers = NULL;
+    owner->residentPages++;
+    if (owner->process != NULL)
+        owner->process->stat->updateResidentPages(owner->residentPages);
+    policy->PageLoaded(np, owner, virtualPage);
+    WakePageOutDaemon();
+    // The page stays locked until the end of the page fault
+    // (see UnlockPage)
+
+    // The page content is about to change
+    g_machine->decodeCache->InvalidatePage(np);
     return np;
 #endif
 }
 
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::AddPrefetchMapping
+
+//
+
+/*! This method returns a new physical page number for a page read
+
+//  ahead by the page fault manager, before it is accessed. Pages are
+
+//  never evicted for that: -1 is returned if there is no free page.
+
+//  As with AddPhysicalToVirtualMapping, the page is locked.
+
+//
+
+//  \param owner address space (for backlink)
+
+//  \param virtualPage is the number of virtualPage to link with physical page
+
+//  \return A new physical page number, -1 if there is no free page.
+
+*/
+
+//-----------------------------------------------------------------
+
+int PhysicalMemManager::AddPrefetchMapping(AddrSpace* owner, int virtualPage) {
+
+    if (free_page_list.IsEmpty())
+
+        return -1;
+
+    int np = AddPhysicalToVirtualMapping(owner, virtualPage);
+
+    g_stats->incrPrefetchedPages();
+
+    return np;
+
+}
+
+
+
 //-----------------------------------------------------------------
 
 // PhysicalMemManager::FindFreePage
@@ -259,6 +424,8 @@ int PhysicalMemManager::FindFreePage() {
 
     page = (int64_t)free_page_list.Remove();
 
+    numFreePages--;
+
     // Check that the page is really free
 
     ASSERT(tpr[page].free);
@@ -276,13 +443,17 @@ int PhysicalMemManager::FindFreePage() {
 
 //
 
-/*! This method implements page replacement, using the well-known
+/*! This method implements page replacement: the victim is chosen
 
-//  clock algorithm.
+//  by the replacement policy selected in the configuration file
+
+//  (see replacement.h), and is evicted from all its mappings.
 
 //
 
-//  \return A new free physical page number.
+//  \return A new free physical page number, -1 if all the pages are
+
+//  locked.
 
 */
 
@@ -297,49 +468,1059 @@ int PhysicalMemManager::EvictPage() {
     return (0);
 #endif
 #ifdef ETUDIANTS_TP
-    int numSwapSector = -1;
-    auto fullLocked = true;
-    int local_iclock = (i_clock+1)%g_cfg->NumPhysPages;
-    while(local_iclock != i_clock) {
-
-        auto U = g_machine->mmu->translationTable->getBitU(tpr[local_iclock].virtualPage);
-        if (U == false) {
-            if (tpr[local_iclock].locked == false) {
-                tpr[local_iclock].locked = true;
-                DEBUG('v', "Virtual page number : %d | Physical page number : %d\n", tpr[local_iclock].virtualPage, local_iclock);
-                while (g_machine->mmu->translationTable->getBitIo(tpr[local_iclock].virtualPage))
-                {
-                    g_current_thread->Yield();
-                }
-                g_machine->mmu->translationTable->setBitIo(tpr[local_iclock].virtualPage);
-
-                i_clock = local_iclock;
-                numSwapSector = g_swap_manager->PutPageSwap(-1,
-                    (char*)&(g_machine->mainMemory[g_machine->mmu->translationTable->getPhysicalPage(tpr[local_iclock].virtualPage) * g_cfg->PageSize]));
-                fullLocked = false;
-                g_machine->mmu->translationTable->setAddrDisk(tpr[local_iclock].virtualPage, numSwapSector);
-                g_machine->mmu->translationTable->setBitSwap(tpr[local_iclock].virtualPage);
-                g_machine->mmu->translationTable->clearBitValid(tpr[local_iclock].virtualPage);
-                g_machine->mmu->translationTable->clearBitIo(tpr[local_iclock].virtualPage);
-                
+    int victim = policy->ChooseVictim();
+
+    if (victim == -1)
+        return -1;
+
+    tpr[victim].locked = true;
+    DEBUG('v', "Virtual page number : %d | Physical page number : %d\n",
+          tpr[victim].virtualPage, victim);
+    EvictFrame(victim);
+    return victim;
+#endif
+}
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::IsReferenced
+
+//
+
+/*! Tells if a physical page was referenced since the last pass of
+
+//  the clock, through any of its mappings
+
+//
+
+//  \param numPage is the number of the real page
+
+*/
+
+//-----------------------------------------------------------------
+
+bool PhysicalMemManager::IsReferenced(long numPage) {
+
+    if (tpr[numPage].owner->translationTable->getBitU(tpr[numPage].virtualPage))
+
+        return true;
+
+    for (struct mapping_c *s = tpr[numPage].sharers; s != NULL; s = s->next)
+
+        if (s->owner->translationTable->getBitU(s->virtualPage))
+
+            return true;
+
+    return false;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::EvictFrame
+
+//
+
+/*! Unmaps a locked physical page from all the address spaces it is
+
+//  mapped in, before giving it to another virtual page. A modified
+
+//  page is written to the swap area first. Its swap sector is reused
+
+//  if it belongs to this page only, otherwise a new sector is
+
+//  allocated and shared by all the mappings of the page.
+
+//
+
+//  \param numPage is the number of the real page
+
+*/
+
+//-----------------------------------------------------------------
+
+void PhysicalMemManager::EvictFrame(long numPage) {
+
+    SaveFrame(numPage, UnmapFrame(numPage));
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::UnmapFrame
+
+//
+
+/*! Unmaps a locked physical page from all the address spaces it is
+
+//  mapped in, and marks it as being transferred, so that the processes
+
+//  using it wait for the end of its eviction if they access it.
+
+//
+
+//  \param numPage is the number of the real page
+
+//  \return true if the page was modified through any of its mappings
+
+*/
+
+//-----------------------------------------------------------------
+
+bool PhysicalMemManager::UnmapFrame(long numPage) {
+
+    ASSERT(tpr[numPage].locked);
+
+    struct mapping_c ownerMapping = { tpr[numPage].owner, tpr[numPage].virtualPage,
+
+                                      tpr[numPage].sharers };
+
+    struct mapping_c *m;
+
+    // Wait for the end of the transfers in progress on the page
+
+    bool busy = true;
+
+    while (busy) {
+
+        busy = false;
+
+        ownerMapping.owner = tpr[numPage].owner;
+
+        ownerMapping.virtualPage = tpr[numPage].virtualPage;
+
+        ownerMapping.next = tpr[numPage].sharers;
+
+        for (m = &ownerMapping; m != NULL; m = m->next)
+
+            if (m->owner->translationTable->getBitIo(m->virtualPage)) {
+
+                busy = true;
+
+                WaitPageIo(m->owner, m->virtualPage);
+
                 break;
+
             }
-        }
-        g_machine->mmu->translationTable->clearBitU(tpr[local_iclock].virtualPage);
-      
-      
-      local_iclock = (local_iclock +1)%g_cfg->NumPhysPages;
+
+    }
+
+    // A shared read-only page of an executable file is forgotten
+
+    if (tpr[numPage].textKey != -1) {
+
+        textFrames.erase(tpr[numPage].textKey);
+
+        tpr[numPage].textKey = -1;
+
     }
-    
-    if (fullLocked) {
-      g_current_thread->Yield();
-      local_iclock = this->EvictPage();
+
+    // Unmap the page before writing it out, so that the processes
+
+    // using it wait for the end of the transfer if they access it
+
+    bool dirty = false;
+
+    for (m = &ownerMapping; m != NULL; m = m->next) {
+
+        TranslationTable *table = m->owner->translationTable;
+
+        table->setBitIo(m->virtualPage);
+
+        table->clearBitValid(m->virtualPage);
+
+        dirty = dirty || table->getBitM(m->virtualPage);
+
     }
-    return local_iclock;
 
-#endif
+    return dirty;
+
 }
 
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::SaveFrame
+
+//
+
+/*! Second half of the eviction of a physical page, after UnmapFrame.
+
+//  A modified page is written to the swap area, or to its file for a
+
+//  memory-mapped file, unless no address space uses it anymore. The
+
+//  page is then forgotten by its mappings.
+
+//
+
+//  \param numPage is the number of the real page
+
+//  \param dirty is true if the page must be written back
+
+*/
+
+//-----------------------------------------------------------------
+
+void PhysicalMemManager::SaveFrame(long numPage, bool dirty) {
+
+    struct mapping_c ownerMapping = { tpr[numPage].owner, tpr[numPage].virtualPage,
+
+                                      tpr[numPage].sharers };
+
+    struct mapping_c *m;
+
+    if (dirty && (tpr[numPage].refCount > 0)
+
+        && (ownerMapping.owner->findMappedFile(ownerMapping.virtualPage * g_cfg->PageSize) != NULL)) {
+
+        // Page of a memory-mapped file: written back to the file. The
+
+        // address space waits for the end of the transfer before it
+
+        // unmaps the file (see AddrSpace::UnmapFile)
+
+        ownerMapping.owner->WriteBackMappedPage(ownerMapping.virtualPage,
+
+            (char*)&(g_machine->mainMemory[numPage * g_cfg->PageSize]));
+
+        ownerMapping.owner = tpr[numPage].owner;
+
+        ownerMapping.virtualPage = tpr[numPage].virtualPage;
+
+        ownerMapping.next = tpr[numPage].sharers;
+
+        if (tpr[numPage].refCount > 0)
+
+            for (m = &ownerMapping; m != NULL; m = m->next)
+
+                m->owner->translationTable->clearBitM(m->virtualPage);
+
+    } else if (dirty && (tpr[numPage].refCount > 0)) {
+
+        // Dirty page: write it back, in its swap sector if no other
+
+        // page uses it
+
+        TranslationTable *table = ownerMapping.owner->translationTable;
+
+        int vp = ownerMapping.virtualPage;
+
+        bool reuse = (ownerMapping.next == NULL) && table->getBitSwap(vp)
+
+            && (table->getAddrDisk(vp) >= 0)
+
+            && !g_swap_manager->IsSharedPageSwap(table->getAddrDisk(vp));
+
+        int numSwapSector = g_swap_manager->PutPageSwap(
+
+            reuse ? table->getAddrDisk(vp) : -1,
+
+            (char*)&(g_machine->mainMemory[numPage * g_cfg->PageSize]));
+
+        g_stats->incrDirtyWritebacks();
+
+        // Address spaces deleted during the transfer are not mapped
+
+        // anymore (see AbandonPage)
+
+        ownerMapping.owner = tpr[numPage].owner;
+
+        ownerMapping.virtualPage = tpr[numPage].virtualPage;
+
+        ownerMapping.next = tpr[numPage].sharers;
+
+        if (tpr[numPage].refCount == 0) {
+
+            if (!reuse)
+
+                g_swap_manager->ReleasePageSwap(numSwapSector);
+
+        } else {
+
+            for (m = &ownerMapping; m != NULL; m = m->next) {
+
+                table = m->owner->translationTable;
+
+                vp = m->virtualPage;
+
+                if (!reuse) {
+
+                    if (table->getBitSwap(vp) && (table->getAddrDisk(vp) >= 0))
+
+                        g_swap_manager->ReleasePageSwap(table->getAddrDisk(vp));
+
+                    if (m != &ownerMapping)
+
+                        g_swap_manager->SharePageSwap(numSwapSector);
+
+                    table->setAddrDisk(vp, numSwapSector);
+
+                    table->setBitSwap(vp);
+
+                }
+
+                table->clearBitM(vp);
+
+            }
+
+        }
+
+    } else {
+
+        // Clean page: its swap sector, the executable file or a
+
+        // zero-filled page give it back on the next fault
+
+        g_stats->incrCleanDrops();
+
+    }
+
+    if (tpr[numPage].refCount > 0) {
+
+        for (m = &ownerMapping; m != NULL; m = m->next) {
+
+            EndPageIo(m->owner, m->virtualPage);
+
+            m->owner->residentPages--;
+
+        }
+
+    }
+
+    while (tpr[numPage].sharers != NULL) {
+
+        m = tpr[numPage].sharers;
+
+        tpr[numPage].sharers = m->next;
+
+        delete m;
+
+    }
+
+    tpr[numPage].refCount = 0;
+
+    tpr[numPage].owner = NULL;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::StartPageOutDaemon
+
+//
+
+/*! Starts the page-out daemon, a kernel thread keeping at least
+
+//  LowWatermark free physical pages. There is no daemon if LowWatermark
+
+//  is 0.
+
+//
+
+//  \param owner is the process the daemon thread is attached to
+
+*/
+
+//-----------------------------------------------------------------
+
+static void PageOutDaemonThread(void) {
+
+    g_machine->interrupt->SetStatus(INTERRUPTS_ON);
+
+    g_physical_mem_manager->PageOutDaemon();
+
+}
+
+void PhysicalMemManager::StartPageOutDaemon(Process* owner) {
+
+    if (g_cfg->LowWatermark == 0)
+
+        return;
+
+    pageOutWakeup = new Semaphore((char*)"page-out daemon", 0);
+
+    Thread *daemon = new Thread((char*)"page-out daemon");
+
+    int err = daemon->StartKernel(owner, PageOutDaemonThread);
+
+    ASSERT(err == NO_ERROR);
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::WakePageOutDaemon
+
+//
+
+/*! Wakes the page-out daemon up if there are less than LowWatermark
+
+//  free pages, and it is not running already. It only runs when the
+
+//  current thread gives up the processor, typically to wait for the disk.
+
+*/
+
+//-----------------------------------------------------------------
+
+void PhysicalMemManager::WakePageOutDaemon() {
+
+    if ((pageOutWakeup == NULL) || pageOutRunning
+
+        || (numFreePages >= g_cfg->LowWatermark))
+
+        return;
+
+    pageOutRunning = true;
+
+    pageOutWakeup->V();
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::PageOutDaemon
+
+//
+
+/*! Body of the page-out daemon thread. Each time it is woken up, it
+
+//  evicts pages until there are HighWatermark free pages. The victims
+
+//  are chosen by the replacement policy, and written back by batches:
+
+//  all the victims of a round are unmapped, then the dirty ones are
+
+//  written to the swap one after the other, in consecutive sectors when
+
+//  they are free. It stops early if all the pages are locked.
+
+*/
+
+//-----------------------------------------------------------------
+
+void PhysicalMemManager::PageOutDaemon() {
+
+    int *batch = new int[g_cfg->NumPhysPages];
+
+    bool *dirty = new bool[g_cfg->NumPhysPages];
+
+    while (true) {
+
+        pageOutWakeup->P();
+
+        g_stats->incrPageOutWakeups();
+
+        while (numFreePages < g_cfg->HighWatermark) {
+
+            // Choose and unmap the victims of the round
+
+            int wanted = g_cfg->HighWatermark - numFreePages;
+
+            int n;
+
+            for (n = 0; n < wanted; n++) {
+
+                int victim = policy->ChooseVictim();
+
+                if (victim == -1)
+
+                    break;
+
+                tpr[victim].locked = true;
+
+                DEBUG('v', (char *)"Page-out of virtual page %d, physical page %d\n",
+
+                              tpr[victim].virtualPage, victim);
+
+                batch[n] = victim;
+
+                dirty[n] = UnmapFrame(victim);
+
+            }
+
+            if (n == 0)
+
+                break;
+
+            // Write them back and free them
+
+            for (int i = 0; i < n; i++) {
+
+                SaveFrame(batch[i], dirty[i]);
+
+                ReleaseFrame(batch[i]);
+
+                g_stats->incrPageOutPages();
+
+            }
+
+        }
+
+        pageOutRunning = false;
+
+    }
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::MapSharedPage
+
+//
+
+/*! Looks for a read-only page of an executable file already in
+
+//  memory, and maps it at a virtual page of an address space.
+
+//  If the page is being loaded by another process, waits for the
+
+//  end of the loading.
+
+//
+
+//  \param owner address space in which the page is mapped
+
+//  \param virtualPage is the virtual page to map
+
+//  \param fileSector is the sector of the header of the executable file
+
+//  \param offset is the offset of the page in the executable file
+
+//  \return the physical page number, -1 if the page is not in memory
+
+*/
+
+//-----------------------------------------------------------------
+
+int PhysicalMemManager::MapSharedPage(AddrSpace* owner, int virtualPage,
+
+                                      int fileSector, int offset) {
+
+    int64_t key = TextKey(fileSector, offset);
+
+    map<int64_t,int>::iterator it = textFrames.find(key);
+
+    while ((it != textFrames.end()) && tpr[it->second].locked) {
+
+        WaitPageUnlocked(it->second);
+
+        it = textFrames.find(key);
+
+    }
+
+    if (it == textFrames.end())
+
+        return -1;
+
+    int np = it->second;
+
+    AddSharer(np, owner, virtualPage);
+
+    g_stats->incrSharedPages();
+
+    return np;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::ShareTextPage
+
+//
+
+/*! Records a read-only page of an executable file, so that other
+
+//  processes running the same program map it instead of loading
+
+//  it again. Must be called while the page is still locked, before
+
+//  it is loaded.
+
+//
+
+//  \param numPage is the number of the real page
+
+//  \param fileSector is the sector of the header of the executable file
+
+//  \param offset is the offset of the page in the executable file
+
+*/
+
+//-----------------------------------------------------------------
+
+void PhysicalMemManager::ShareTextPage(long numPage, int fileSector, int offset) {
+
+    ASSERT(tpr[numPage].locked);
+
+    int64_t key = TextKey(fileSector, offset);
+
+    // Another process may have loaded the same page meanwhile: this
+
+    // copy stays private
+
+    if (textFrames.find(key) != textFrames.end())
+
+        return;
+
+    textFrames[key] = numPage;
+
+    tpr[numPage].textKey = key;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::AddSharer
+
+//
+
+/*! Maps a physical page in one more address space, sharing it with
+
+//  the address spaces it is already mapped in
+
+//
+
+//  \param numPage is the number of the real page
+
+//  \param owner address space in which the page is mapped
+
+//  \param virtualPage is the virtual page to map
+
+*/
+
+//-----------------------------------------------------------------
+
+void PhysicalMemManager::AddSharer(long numPage, AddrSpace* owner, int virtualPage) {
+
+    ASSERT(!tpr[numPage].free);
+
+    struct mapping_c *s = new struct mapping_c;
+
+    s->owner = owner;
+
+    s->virtualPage = virtualPage;
+
+    s->next = tpr[numPage].sharers;
+
+    tpr[numPage].sharers = s;
+
+    tpr[numPage].refCount++;
+
+    owner->residentPages++;
+
+    if (owner->process != NULL)
+
+        owner->process->stat->updateResidentPages(owner->residentPages);
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::UnsharePage
+
+//
+
+/*! Gives a private copy of a shared physical page to one of the
+
+//  address spaces it is mapped in. If the page is not shared anymore,
+
+//  it is kept as is. The page returned is locked: don't forget to
+
+//  unlock it.
+
+//
+
+//  \param numPage is the number of the real page
+
+//  \param owner address space which wants a private copy
+
+//  \param virtualPage is the virtual page of the mapping
+
+//  \return the physical page now mapped at virtualPage
+
+*/
+
+//-----------------------------------------------------------------
+
+int PhysicalMemManager::UnsharePage(long numPage, AddrSpace* owner, int virtualPage) {
+
+    ASSERT(!tpr[numPage].locked);
+
+    // The page must not be evicted while it is copied
+
+    tpr[numPage].locked = true;
+
+    if (tpr[numPage].refCount == 1)
+
+        return numPage;
+
+    int copy = AddPhysicalToVirtualMapping(owner, virtualPage);
+
+    memcpy(&(g_machine->mainMemory[copy * g_cfg->PageSize]),
+
+           &(g_machine->mainMemory[numPage * g_cfg->PageSize]),
+
+           g_cfg->PageSize);
+
+    UnlockPage(numPage);
+
+    RemovePhysicalToVirtualMapping(numPage, owner, virtualPage);
+
+    return copy;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::UnlinkMapping
+
+//
+
+/*! Forgets a mapping of a physical page. If it was the mapping of the
+
+//  owner, the first sharer of the page, if any, becomes its owner.
+
+//  The page is not freed.
+
+//
+
+//  \param numPage is the number of the real page
+
+//  \param owner is the address space of the mapping
+
+//  \param virtualPage is the virtual page of the mapping
+
+*/
+
+//-----------------------------------------------------------------
+
+void PhysicalMemManager::UnlinkMapping(long numPage, AddrSpace* owner, int virtualPage) {
+
+    owner->residentPages--;
+
+    tpr[numPage].refCount--;
+
+    if ((tpr[numPage].owner == owner) && (tpr[numPage].virtualPage == virtualPage)) {
+
+        // The first sharer, if any, becomes the owner of the page
+
+        struct mapping_c *first = tpr[numPage].sharers;
+
+        if (first != NULL) {
+
+            tpr[numPage].owner = first->owner;
+
+            tpr[numPage].virtualPage = first->virtualPage;
+
+            tpr[numPage].sharers = first->next;
+
+            delete first;
+
+        } else
+
+            tpr[numPage].owner = NULL;
+
+    } else {
+
+        struct mapping_c **s = &tpr[numPage].sharers;
+
+        while ((*s)->owner != owner || (*s)->virtualPage != virtualPage)
+
+            s = &(*s)->next;
+
+        struct mapping_c *removed = *s;
+
+        *s = removed->next;
+
+        delete removed;
+
+    }
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::AbandonPage
+
+//
+
+/*! Called when an address space is deleted while one of its pages
+
+//  is being written to the swap by another process. The page table
+
+//  is not accessed anymore at the end of the transfer. If it was
+
+//  the last mapping of the page, the swap sector of the page is
+
+//  freed instead.
+
+//
+
+//  \param numPage is the number of the real page
+
+//  \param owner is the address space being deleted
+
+//  \param virtualPage is the virtual page of the mapping
+
+*/
+
+//-----------------------------------------------------------------
+
+void PhysicalMemManager::AbandonPage(long numPage, AddrSpace* owner, int virtualPage) {
+
+    ASSERT(tpr[numPage].locked);
+
+    UnlinkMapping(numPage, owner, virtualPage);
+
+    // Nobody will clear the io bit of this mapping
+
+    WakeUp(owner, virtualPage);
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::WaitPageIo
+
+//
+
+/*! Puts the current thread to sleep until the end of the transfer of
+
+//  a virtual page (io bit set), if there is one. The caller must check
+
+//  the state of the page again when it is woken up: the page may have
+
+//  been evicted or the address space deleted meanwhile.
+
+//
+
+//  \param owner is the address space of the page
+
+//  \param virtualPage is the virtual page
+
+*/
+
+//-----------------------------------------------------------------
+
+void PhysicalMemManager::WaitPageIo(AddrSpace* owner, int virtualPage) {
+
+    if (owner->translationTable->getBitIo(virtualPage))
+
+        Wait(owner, virtualPage);
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::EndPageIo
+
+//
+
+/*! Clears the io bit of a virtual page at the end of its transfer,
+
+//  and wakes up the threads waiting for it
+
+//
+
+//  \param owner is the address space of the page
+
+//  \param virtualPage is the virtual page
+
+*/
+
+//-----------------------------------------------------------------
+
+void PhysicalMemManager::EndPageIo(AddrSpace* owner, int virtualPage) {
+
+    owner->translationTable->clearBitIo(virtualPage);
+
+    WakeUp(owner, virtualPage);
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::WaitPageUnlocked
+
+//
+
+/*! Puts the current thread to sleep until a physical page is
+
+//  unlocked, if it is locked. As with WaitPageIo, the caller must
+
+//  check the state of the page again.
+
+//
+
+//  \param numPage is the number of the real page
+
+*/
+
+//-----------------------------------------------------------------
+
+void PhysicalMemManager::WaitPageUnlocked(long numPage) {
+
+    if (tpr[numPage].locked)
+
+        Wait(NULL, numPage);
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::WaitAnyFrame
+
+//
+
+/*! Puts the current thread to sleep until any physical page is
+
+//  unlocked or freed. Used when all the pages are locked, and no
+
+//  victim can be found to free one.
+
+*/
+
+//-----------------------------------------------------------------
+
+void PhysicalMemManager::WaitAnyFrame() {
+
+    numFrameWaiters++;
+
+    Wait(NULL, ANY_FRAME);
+
+    numFrameWaiters--;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::Wait
+
+//
+
+/*! Puts the current thread to sleep in the wait queue of a virtual
+
+//  page, or of a physical page if owner is NULL. The wait queues are
+
+//  hashed, but only the waiters of the given page are woken up.
+
+//
+
+//  \param owner is the address space of the page, NULL for a physical page
+
+//  \param page is the virtual or physical page number
+
+*/
+
+//-----------------------------------------------------------------
+
+void PhysicalMemManager::Wait(AddrSpace* owner, int page) {
+
+    struct waiter_c waiter = { g_current_thread, owner, page, NULL };
+
+    struct waiter_c **q = &waitQueues[WaitQueue(owner, page)];
+
+    IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+
+    // The waiters are woken up in arrival order
+
+    while (*q != NULL)
+
+        q = &(*q)->next;
+
+    *q = &waiter;
+
+    g_stats->incrPageWaits();
+
+    g_current_thread->Sleep();
+
+    g_machine->interrupt->SetStatus(oldLevel);
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// PhysicalMemManager::WakeUp
+
+//
+
+/*! Wakes up all the threads waiting for a virtual page, or for a
+
+//  physical page if owner is NULL
+
+//
+
+//  \param owner is the address space of the page, NULL for a physical page
+
+//  \param page is the virtual or physical page number
+
+*/
+
+//-----------------------------------------------------------------
+
+void PhysicalMemManager::WakeUp(AddrSpace* owner, int page) {
+
+    struct waiter_c **q = &waitQueues[WaitQueue(owner, page)];
+
+    IntStatus oldLevel = g_machine->interrupt->SetStatus(INTERRUPTS_OFF);
+
+    while (*q != NULL) {
+
+        if (((*q)->owner == owner) && ((*q)->page == page)) {
+
+            g_scheduler->ReadyToRun((*q)->thread);
+
+            *q = (*q)->next;
+
+        } else
+
+            q = &(*q)->next;
+
+    }
+
+    g_machine->interrupt->SetStatus(oldLevel);
+
+}
+
+
+
 //-----------------------------------------------------------------
 
 // PhysicalMemManager::Print
@@ -42,8 +42,18 @@ class PhysicalMemManager;
 
 #include "vm/swapManager.h"
 
+#include "vm/replacement.h"
+
 #include "utility/list.h"
 
+#include <map>
+
+
+
+//! Page of the wait queue of the threads waiting for any physical page
+
+#define ANY_FRAME -1
+
 
 
 //-----------------------------------------------------------------
@@ -60,13 +70,43 @@ class PhysicalMemManager;
 
    
 
-   It processes a new page demand by applying the clock algorithm when 
+   It processes a new page demand by evicting a page when there is no
+
+   page available. The page to evict is chosen by the replacement policy
+
+   selected in the configuration file (see replacement.h), and is saved
+
+   in the swap area if needed using the SwapManager class.
+
+
+
+   A page-out daemon keeps free pages in reserve, so that page faults
+
+   seldom have to evict a page themselves: it is woken up when there
 
-   there is no page available. It requires an access to the thread list
+   are less than LowWatermark free pages, and evicts pages until there
 
-   in order to choose which page will be swapped using the SwapManager
+   are HighWatermark of them.
 
-   class.
+
+
+   Read-only pages loaded from an executable file (text, rodata) are
+
+   shared: a page already in memory for a process running the same
+
+   program is mapped in the address space of the faulting process
+
+   instead of being read again.
+
+
+
+   After a Fork, all the pages of the parent process are shared with
+
+   the child in the same way, until one of them writes the page and
+
+   gets a private copy of it (see UnsharePage). A shared page is
+
+   evicted from all the address spaces it is mapped in at once.
 
 */
 
@@ -86,14 +126,46 @@ public:
 
   int AddPhysicalToVirtualMapping(AddrSpace* owner,int vp); //!< Finds a new page and adds a new page mapping
 
-  void RemovePhysicalToVirtualMapping(long numPage); //!< Frees the page and deletes the existing page mapping
+  int AddPrefetchMapping(AddrSpace* owner,int vp); //!< Same, only if a page is free, for a page read ahead
+
+  int GetNumFreePages() { return numFreePages; } //!< Number of pages in the free list
+
+  void RemovePhysicalToVirtualMapping(long numPage, AddrSpace* owner, int vp); //!< Deletes a page mapping, frees the page if it was the last one
+
+  void AbandonPage(long numPage, AddrSpace* owner, int vp); //!< Forgets a mapping of a page being written to the swap
+
+  void AddSharer(long numPage, AddrSpace* owner, int vp); //!< Maps a page in one more address space
+
+  int UnsharePage(long numPage, AddrSpace* owner, int vp); //!< Gives a private copy of a shared page to an address space
+
+  int MapSharedPage(AddrSpace* owner, int vp, int fileSector, int offset); //!< Maps a shared read-only page already in memory
+
+  void ShareTextPage(long numPage, int fileSector, int offset); //!< Makes a newly loaded read-only page shareable
+
+  bool IsTextPageResident(int fileSector, int offset) //!< true if a shared read-only page is in memory
+
+    { return textFrames.find(TextKey(fileSector, offset)) != textFrames.end(); }
 
   void ChangeOwner(long numPage, Thread* owner);   //!< Change the page owner
 
   void UnlockPage(long numPage); //!< Unlock physical page
 
+  bool IsLocked(long numPage) { return tpr[numPage].locked; } //!< true if the page cannot be evicted
+
+  void WaitPageIo(AddrSpace* owner, int vp); //!< Sleeps until the end of the transfer of a virtual page
+
+  void EndPageIo(AddrSpace* owner, int vp); //!< Clears the io bit of a virtual page and wakes up its waiters
+
+  void WaitPageUnlocked(long numPage); //!< Sleeps until a physical page is unlocked
+
+  void WaitAnyFrame(); //!< Sleeps until any physical page is unlocked or freed
+
   void Print(void); //!< Print the contents of a page
 
+  void StartPageOutDaemon(Process* owner); //!< Starts the thread keeping free pages in reserve
+
+  void PageOutDaemon(); //!< Body of the page-out daemon thread
+
  
 
 private:
@@ -102,11 +174,65 @@ private:
 
   int EvictPage();               //!< Return a free page when there is none
 
+  void EvictFrame(long numPage); //!< Unmaps a page from all its mappings, saving it if needed
+
+  bool UnmapFrame(long numPage); //!< First half of EvictFrame: unmaps a page, tells if it is dirty
+
+  void SaveFrame(long numPage, bool dirty); //!< Second half of EvictFrame: saves an unmapped page
+
+  void ReleaseFrame(long numPage); //!< Puts a page not mapped anymore in the free list
+
+  void WakePageOutDaemon(); //!< Wakes the page-out daemon up when free pages run low
+
+  void Wait(AddrSpace* owner, int page); //!< Sleeps in the wait queue of a page
+
+  void WakeUp(AddrSpace* owner, int page); //!< Wakes up the threads waiting for a page
+
+
+
+  //! Wait queue of a virtual page, or of a physical page if owner is NULL
+
+  int WaitQueue(AddrSpace* owner, int page)
+
+    { return (int)((((uintptr_t)owner >> 4) + (uintptr_t)page * 2654435761u) % numWaitQueues); }
+
+
+
+  void UnlinkMapping(long numPage, AddrSpace* owner, int vp); //!< Forgets a mapping of a page
+
+  bool IsReferenced(long numPage); //!< Tests the U bit of all the mappings of a page
+
+
+
+  //! Key of a read-only page of an executable file in textFrames
+
+  static int64_t TextKey(int fileSector, int offset)
+
+    { return ((int64_t)fileSector << 32) | (uint32_t)offset; }
+
+
+
+  //! Mapping of a shared physical page
+
+  struct mapping_c {
+
+    AddrSpace* owner;		//!< Address space of the sharing process
+
+    int virtualPage;		//!< Virtual page of the sharing process
+
+    struct mapping_c *next;	//!< Next mapping of the page
+
+  };
+
 
 
   /*! \brief Describes the allocation of physical pages. Bits U (used/referenced) and M
 
-    (modified/dirty) are in the page table entry and are directly set by the MMU hardware */
+    (modified/dirty) are in the page table entry and are directly set by the MMU hardware.
+
+    This is the reverse map of the page tables: the page table entry of a physical
+
+    page is found through its owner, whatever the current process is. */
 
   struct tpr_c {
 
@@ -118,6 +244,12 @@ private:
 
     AddrSpace* owner;	//!< Address space of the owner process
 
+    int refCount;		//!< Number of mappings of the page (owner and sharers)
+
+    struct mapping_c *sharers;	//!< Mappings of the page other than the owner one
+
+    int64_t textKey;		//!< Key in textFrames if the page is shared, -1 otherwise
+
   }; 
 
 
@@ -130,12 +262,56 @@ private:
 
 
 
-  int i_clock;          //!< Index for clock_algorithm
+  int numFreePages;     //!< Number of pages in free_page_list
+
+
+
+  ReplacementPolicy *policy; //!< Chooses the pages to evict
+
+
+
+  Semaphore *pageOutWakeup; //!< The page-out daemon waits on it, NULL if there is no daemon
+
+  bool pageOutRunning;      //!< true if the page-out daemon was woken up and did not finish
+
+  int numFrameWaiters;      //!< Number of threads sleeping in WaitAnyFrame
+
+
+
+  //! Thread sleeping until the end of the transfer of a virtual page,
+
+  //! or until a physical page is unlocked
+
+  struct waiter_c {
+
+    Thread* thread;		//!< The sleeping thread
+
+    AddrSpace* owner;		//!< Address space of the page, NULL for a physical page
+
+    int page;			//!< Virtual or physical page number
+
+    struct waiter_c *next;	//!< Next waiter of the same wait queue
+
+  };
+
+
+
+  struct waiter_c **waitQueues; //!< Hashed wait queues of the pages
+
+  int numWaitQueues;            //!< Number of wait queues
+
+
+
+  map<int64_t,int> textFrames; //!< Read-only pages of executable files in memory,
+
+                               //!< by file header sector and offset
 
 
 
   friend class AddrSpace;      //!< Direct access to page table for programm loading
 
+  friend class ReplacementPolicy; //!< Direct access to the physical pages state
+
 };
 
 
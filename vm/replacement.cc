@@ -0,0 +1,980 @@
+//-----------------------------------------------------------------
+
+/*! \file replacement.cc
+
+//  \brief Page replacement policies of the physical memory manager
+
+*/
+
+//
+
+//  Copyright (c) 1999-2000 INSA de Rennes.
+
+//  All rights reserved.
+
+//  See copyright_insa.h for copyright notice and limitation
+
+//  of liability and disclaimer of warranty provisions.
+
+//-----------------------------------------------------------------
+
+
+
+#include "vm/replacement.h"
+
+#include "vm/physMem.h"
+
+
+
+#include <string.h>
+
+
+
+//-----------------------------------------------------------------
+
+// NewReplacementPolicy
+
+//
+
+/*! Create the replacement policy selected by the PageReplacement
+
+//  entry of the configuration file
+
+//
+
+//  \param mem is the memory manager of the physical pages
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+ReplacementPolicy *NewReplacementPolicy(PhysicalMemManager *mem) {
+
+
+
+    switch (g_cfg->PageReplacement) {
+
+    case POLICY_TWO_HANDED_CLOCK:
+
+        return new TwoHandedClockPolicy(mem);
+
+    case POLICY_WSCLOCK:
+
+        return new WSClockPolicy(mem);
+
+    case POLICY_AGING:
+
+        return new AgingPolicy(mem);
+
+    case POLICY_CLOCK_PRO:
+
+        return new ClockProPolicy(mem);
+
+    default:
+
+        return new ClockPolicy(mem);
+
+    }
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// ReplacementPolicy::ReplacementPolicy
+
+//
+
+/*! Constructor.
+
+//
+
+//  \param mem is the memory manager of the physical pages
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+ReplacementPolicy::ReplacementPolicy(PhysicalMemManager *m) {
+
+    mem = m;
+
+    numFrames = g_cfg->NumPhysPages;
+
+}
+
+
+
+bool ReplacementPolicy::IsFree(long numPage) {
+
+    return mem->tpr[numPage].free;
+
+}
+
+
+
+bool ReplacementPolicy::IsLocked(long numPage) {
+
+    return mem->tpr[numPage].locked;
+
+}
+
+
+
+bool ReplacementPolicy::IsReferenced(long numPage) {
+
+    return mem->IsReferenced(numPage);
+
+}
+
+
+
+AddrSpace *ReplacementPolicy::Owner(long numPage) {
+
+    return mem->tpr[numPage].owner;
+
+}
+
+
+
+int ReplacementPolicy::VirtualPage(long numPage) {
+
+    return mem->tpr[numPage].virtualPage;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// ReplacementPolicy::ClearReferenced
+
+//
+
+/*! Clears the U bit of a physical page in the page tables of all
+
+//  the address spaces it is mapped in
+
+//
+
+//  \param numPage is the number of the real page
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+void ReplacementPolicy::ClearReferenced(long numPage) {
+
+    struct PhysicalMemManager::mapping_c ownerMapping =
+
+        { mem->tpr[numPage].owner, mem->tpr[numPage].virtualPage,
+
+          mem->tpr[numPage].sharers };
+
+
+
+    for (struct PhysicalMemManager::mapping_c *m = &ownerMapping;
+
+         m != NULL; m = m->next)
+
+        m->owner->translationTable->clearBitU(m->virtualPage);
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// ReplacementPolicy::IsDirty
+
+//
+
+/*! Tells if a physical page was modified through any of its
+
+//  mappings, that is if evicting it needs a write to the swap area
+
+//
+
+//  \param numPage is the number of the real page
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+bool ReplacementPolicy::IsDirty(long numPage) {
+
+    struct PhysicalMemManager::mapping_c ownerMapping =
+
+        { mem->tpr[numPage].owner, mem->tpr[numPage].virtualPage,
+
+          mem->tpr[numPage].sharers };
+
+
+
+    for (struct PhysicalMemManager::mapping_c *m = &ownerMapping;
+
+         m != NULL; m = m->next)
+
+        if (m->owner->translationTable->getBitM(m->virtualPage))
+
+            return true;
+
+
+
+    return false;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// ClockPolicy::ChooseVictim
+
+//
+
+/*! The clock algorithm: the hand goes round the physical pages,
+
+//  starting after the last page evicted. The first page not
+
+//  referenced since the previous pass of the hand is the victim,
+
+//  the reference bit of the others is cleared on the way.
+
+//
+
+//  \return the page to evict, -1 if all the pages are locked
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+ClockPolicy::ClockPolicy(PhysicalMemManager *m) : ReplacementPolicy(m) {
+
+    hand = -1;
+
+}
+
+
+
+int ClockPolicy::ChooseVictim() {
+
+    // Two full rounds: the first one may only clear reference bits
+
+    for (int step = 0; step < 2 * numFrames; step++) {
+
+        hand = (hand + 1) % numFrames;
+
+
+
+        // Free pages are being given back by an exiting process
+
+        if (IsFree(hand))
+
+            continue;
+
+        if (!IsReferenced(hand) && !IsLocked(hand))
+
+            return hand;
+
+        ClearReferenced(hand);
+
+    }
+
+    return -1;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// TwoHandedClockPolicy::ChooseVictim
+
+//
+
+/*! The two-handed clock: the front hand clears the reference bit of
+
+//  the pages, and the back hand, a quarter of the memory behind,
+
+//  evicts the first page that was not referenced since the front
+
+//  hand went by. With a large memory, the pages of the working set
+
+//  have less time to be referenced again than with one hand.
+
+//
+
+//  \return the page to evict, -1 if all the pages are locked
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+TwoHandedClockPolicy::TwoHandedClockPolicy(PhysicalMemManager *m)
+
+    : ReplacementPolicy(m) {
+
+    hand = -1;
+
+    spread = numFrames / 4;
+
+    if (spread < 1)
+
+        spread = 1;
+
+}
+
+
+
+int TwoHandedClockPolicy::ChooseVictim() {
+
+
+
+    for (int step = 0; step < 2 * numFrames; step++) {
+
+        hand = (hand + 1) % numFrames;
+
+        int front = (hand + spread) % numFrames;
+
+        if (!IsFree(front))
+
+            ClearReferenced(front);
+
+        if (IsEvictable(hand) && !IsReferenced(hand))
+
+            return hand;
+
+    }
+
+    return -1;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// WSClockPolicy::ChooseVictim
+
+//
+
+/*! The WSClock algorithm: the hand goes round the physical pages, and
+
+//  records the time at which it sees a page referenced. The first
+
+//  clean page not referenced for WorkingSetWindow cycles is out of the
+
+//  working set of its process, and is the victim. Nachos writes pages
+
+//  back synchronously, so a dirty page out of the working set is only
+
+//  evicted when there is no clean one. Without any page out of the
+
+//  working sets, the page referenced the longest time ago is evicted.
+
+//
+
+//  \return the page to evict, -1 if all the pages are locked
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+WSClockPolicy::WSClockPolicy(PhysicalMemManager *m) : ReplacementPolicy(m) {
+
+    hand = -1;
+
+    lastUse = new Time[numFrames];
+
+    memset(lastUse, 0, numFrames * sizeof(Time));
+
+}
+
+
+
+WSClockPolicy::~WSClockPolicy() {
+
+    delete[] lastUse;
+
+}
+
+
+
+void WSClockPolicy::PageLoaded(long numPage, AddrSpace *owner, int virtualPage) {
+
+    lastUse[numPage] = g_stats->getTotalTicks();
+
+}
+
+
+
+int WSClockPolicy::ChooseVictim() {
+
+    Time now = g_stats->getTotalTicks();
+
+    int oldDirty = -1;
+
+    int oldest = -1;
+
+
+
+    for (int step = 0; step < numFrames; step++) {
+
+        hand = (hand + 1) % numFrames;
+
+        if (!IsEvictable(hand))
+
+            continue;
+
+        if (IsReferenced(hand)) {
+
+            ClearReferenced(hand);
+
+            lastUse[hand] = now;
+
+            continue;
+
+        }
+
+        if (now - lastUse[hand] > (Time)g_cfg->WorkingSetWindow) {
+
+            if (!IsDirty(hand))
+
+                return hand;
+
+            if (oldDirty == -1)
+
+                oldDirty = hand;
+
+        }
+
+        if ((oldest == -1) || (lastUse[hand] < lastUse[oldest]))
+
+            oldest = hand;
+
+    }
+
+
+
+    if (oldDirty != -1)
+
+        hand = oldDirty;
+
+    else if (oldest != -1)
+
+        hand = oldest;
+
+    else {
+
+        // All the pages were referenced: take the first one that was
+
+        // not referenced again since
+
+        for (int step = 0; step < numFrames; step++) {
+
+            hand = (hand + 1) % numFrames;
+
+            if (IsEvictable(hand) && !IsReferenced(hand))
+
+                return hand;
+
+        }
+
+        return -1;
+
+    }
+
+    return hand;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// AgingPolicy::ChooseVictim
+
+//
+
+/*! LRU approximation: each page has an 8-bit counter, shifted right
+
+//  with the reference bit entering on the left at each page
+
+//  replacement (instead of each clock tick, there is no periodic
+
+//  daemon). The page with the smallest counter was not referenced
+
+//  for the longest time and is evicted, the ties being broken by
+
+//  going round the pages from the last victim.
+
+//
+
+//  \return the page to evict, -1 if all the pages are locked
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+AgingPolicy::AgingPolicy(PhysicalMemManager *m) : ReplacementPolicy(m) {
+
+    hand = -1;
+
+    age = new uint8_t[numFrames];
+
+    memset(age, 0, numFrames * sizeof(uint8_t));
+
+}
+
+
+
+AgingPolicy::~AgingPolicy() {
+
+    delete[] age;
+
+}
+
+
+
+void AgingPolicy::PageLoaded(long numPage, AddrSpace *owner, int virtualPage) {
+
+    age[numPage] = 0x80;
+
+}
+
+
+
+int AgingPolicy::ChooseVictim() {
+
+    int victim = -1;
+
+
+
+    for (int i = 0; i < numFrames; i++) {
+
+        if (IsFree(i))
+
+            continue;
+
+        age[i] = (age[i] >> 1) | (IsReferenced(i) ? 0x80 : 0);
+
+        ClearReferenced(i);
+
+    }
+
+
+
+    for (int step = 0; step < numFrames; step++) {
+
+        int i = (hand + 1 + step) % numFrames;
+
+        if (IsEvictable(i) && ((victim == -1) || (age[i] < age[victim])))
+
+            victim = i;
+
+    }
+
+
+
+    if (victim != -1)
+
+        hand = victim;
+
+    return victim;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// ClockProPolicy::ChooseVictim
+
+//
+
+/*! The cold hand goes round the cold pages. A referenced page in its
+
+//  test period becomes hot, a referenced page out of it starts a new
+
+//  one. The first cold page not referenced is the victim; it is
+
+//  remembered as non-resident if it is in its test period. The hot
+
+//  hand runs when there are more hot pages than allowed, and demotes
+
+//  the first hot page not referenced since its previous pass. It also
+
+//  runs when no cold page can be evicted, so that the only pages kept
+
+//  in memory are the locked ones.
+
+//
+
+//  \return the page to evict, -1 if all the pages are locked
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+ClockProPolicy::ClockProPolicy(PhysicalMemManager *m) : ReplacementPolicy(m) {
+
+    handCold = -1;
+
+    handHot = -1;
+
+    hot = new bool[numFrames];
+
+    test = new bool[numFrames];
+
+    memset(hot, 0, numFrames * sizeof(bool));
+
+    memset(test, 0, numFrames * sizeof(bool));
+
+    numHot = 0;
+
+    coldTarget = numFrames / 2;
+
+    if (coldTarget < 1)
+
+        coldTarget = 1;
+
+    nonResident = new struct nonresident_c[numFrames];
+
+    numNonResident = 0;
+
+}
+
+
+
+ClockProPolicy::~ClockProPolicy() {
+
+    delete[] hot;
+
+    delete[] test;
+
+    delete[] nonResident;
+
+}
+
+
+
+int ClockProPolicy::ChooseVictim() {
+
+    int victim = RunHandCold();
+
+
+
+    // The cold pages are all locked or free: demote an unlocked hot page
+
+    // and take it, even if there are not too many hot pages
+
+    if ((victim == -1) && RunHandHot())
+
+        victim = RunHandCold();
+
+    return victim;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// ClockProPolicy::RunHandCold
+
+//
+
+/*! Moves the cold hand until it finds a cold page to evict, running
+
+//  the hot hand on the way when there are too many hot pages.
+
+//
+
+//  \return the page to evict, -1 if no cold page can be evicted
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+int ClockProPolicy::RunHandCold() {
+
+
+
+    for (int step = 0; step < 3 * numFrames; step++) {
+
+
+
+        if (numHot > numFrames - coldTarget)
+
+            RunHandHot();
+
+
+
+        handCold = (handCold + 1) % numFrames;
+
+        if (!IsEvictable(handCold) || hot[handCold])
+
+            continue;
+
+
+
+        if (IsReferenced(handCold)) {
+
+            ClearReferenced(handCold);
+
+            if (test[handCold]) {
+
+                hot[handCold] = true;
+
+                test[handCold] = false;
+
+                numHot++;
+
+            } else
+
+                test[handCold] = true;
+
+            continue;
+
+        }
+
+
+
+        if (test[handCold]) {
+
+            // Keep the page in its test period after the eviction
+
+            if (numNonResident == numFrames) {
+
+                Forget(0);
+
+                EndTest();
+
+            }
+
+            nonResident[numNonResident].owner = Owner(handCold);
+
+            nonResident[numNonResident].virtualPage = VirtualPage(handCold);
+
+            numNonResident++;
+
+            test[handCold] = false;
+
+        }
+
+        return handCold;
+
+    }
+
+    return -1;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// ClockProPolicy::RunHandHot
+
+//
+
+/*! Moves the hot hand until it demotes a hot page not referenced
+
+//  since its previous pass. The cold pages it goes by end their
+
+//  test period.
+
+//
+
+//  \return false if all the hot pages are locked
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+bool ClockProPolicy::RunHandHot() {
+
+
+
+    for (int step = 0; step < 2 * numFrames; step++) {
+
+        handHot = (handHot + 1) % numFrames;
+
+        if (!IsEvictable(handHot))
+
+            continue;
+
+        if (!hot[handHot]) {
+
+            if (test[handHot]) {
+
+                test[handHot] = false;
+
+                EndTest();
+
+            }
+
+            continue;
+
+        }
+
+        if (IsReferenced(handHot)) {
+
+            ClearReferenced(handHot);
+
+            continue;
+
+        }
+
+        hot[handHot] = false;
+
+        numHot--;
+
+        return true;
+
+    }
+
+    return false;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// ClockProPolicy::EndTest
+
+//
+
+/*! A test period ended without a reference: cold pages do not need
+
+//  as much room
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+void ClockProPolicy::EndTest() {
+
+    if (coldTarget > 1)
+
+        coldTarget--;
+
+}
+
+
+
+void ClockProPolicy::Forget(int index) {
+
+    numNonResident--;
+
+    memmove(&nonResident[index], &nonResident[index + 1],
+
+            (numNonResident - index) * sizeof(struct nonresident_c));
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+// ClockProPolicy::PageLoaded
+
+//
+
+/*! A page loaded again during its test period was evicted too early:
+
+//  it is hot, and cold pages need more room. Other pages are cold,
+
+//  and start their test period.
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+void ClockProPolicy::PageLoaded(long numPage, AddrSpace *owner, int virtualPage) {
+
+    int i;
+
+
+
+    if (hot[numPage])
+
+        numHot--;
+
+    hot[numPage] = false;
+
+    test[numPage] = true;
+
+
+
+    for (i = 0; i < numNonResident; i++)
+
+        if ((nonResident[i].owner == owner)
+
+            && (nonResident[i].virtualPage == virtualPage))
+
+            break;
+
+    if (i == numNonResident)
+
+        return;
+
+
+
+    Forget(i);
+
+    hot[numPage] = true;
+
+    test[numPage] = false;
+
+    numHot++;
+
+    if (coldTarget < numFrames - 1)
+
+        coldTarget++;
+
+}
+
+
+
+void ClockProPolicy::PageFreed(long numPage) {
+
+    if (hot[numPage])
+
+        numHot--;
+
+    hot[numPage] = false;
+
+    test[numPage] = false;
+
+}
+
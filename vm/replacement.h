@@ -0,0 +1,368 @@
+//-----------------------------------------------------------------
+
+/*! \file replacement.h
+
+    \brief Page replacement policies of the physical memory manager
+
+
+
+    When there is no free physical page, the physical memory manager
+
+    asks a replacement policy which page to evict. The policies only
+
+    choose the victim: the eviction itself (swap out, unmapping) is
+
+    done by the memory manager (see PhysicalMemManager::EvictFrame).
+
+
+
+    The policy is selected by the PageReplacement entry of the
+
+    configuration file:
+
+    - Clock: the second chance algorithm, with one hand
+
+    - TwoHandedClock: a front hand clears the reference bits, a back
+
+      hand following it at a fixed distance evicts the pages that were
+
+      not referenced in-between
+
+    - WSClock: clock evicting the pages out of the working set
+
+      (not referenced for WorkingSetWindow cycles), clean pages first
+
+    - Aging: LRU approximation, with 8-bit aging counters
+
+    - ClockPro: a simplified CLOCK-Pro, keeping apart hot and cold
+
+      pages, and remembering recently evicted cold pages
+
+
+
+    Copyright (c) 1999-2000 INSA de Rennes.
+
+    All rights reserved.
+
+    See copyright_insa.h for copyright notice and limitation
+
+    of liability and disclaimer of warranty provisions.
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+#ifndef __REPLACEMENT_H
+
+#define __REPLACEMENT_H
+
+
+
+#include "utility/utility.h"
+
+
+
+class PhysicalMemManager;
+
+class AddrSpace;
+
+
+
+//-----------------------------------------------------------------
+
+/*! \brief Interface of the page replacement policies
+
+
+
+   The memory manager tells the policy about the pages it loads and
+
+   frees, and asks it for a victim when it runs out of free pages.
+
+   The helpers give access to the state of the physical pages,
+
+   whatever the address spaces they are mapped in.
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+class ReplacementPolicy {
+
+public:
+
+  ReplacementPolicy(PhysicalMemManager *mem);
+
+  virtual ~ReplacementPolicy() {}
+
+
+
+  //! Return an unlocked physical page to evict, -1 if all are locked
+
+  virtual int ChooseVictim() = 0;
+
+
+
+  //! A physical page was given to a virtual page of an address space
+
+  virtual void PageLoaded(long numPage, AddrSpace *owner, int virtualPage) {}
+
+
+
+  //! A physical page went back to the free list
+
+  virtual void PageFreed(long numPage) {}
+
+
+
+protected:
+
+  int numFrames;			//!< Number of physical pages
+
+
+
+  bool IsFree(long numPage);		//!< true if the page is in the free list
+
+  bool IsLocked(long numPage);		//!< true if the page cannot be evicted
+
+  bool IsReferenced(long numPage);	//!< U bit of any mapping of the page
+
+  void ClearReferenced(long numPage);	//!< Clears the U bit of all the mappings
+
+  bool IsDirty(long numPage);		//!< M bit of any mapping of the page
+
+  bool IsEvictable(long numPage)	//!< true if the page may be a victim
+
+    { return !IsFree(numPage) && !IsLocked(numPage); }
+
+  AddrSpace *Owner(long numPage);	//!< Address space owning the page
+
+  int VirtualPage(long numPage);	//!< Virtual page of the owner mapping
+
+
+
+private:
+
+  PhysicalMemManager *mem;		//!< The memory manager of the pages
+
+};
+
+
+
+//! Create the replacement policy selected in the configuration file
+
+extern ReplacementPolicy *NewReplacementPolicy(PhysicalMemManager *mem);
+
+
+
+//-----------------------------------------------------------------
+
+/*! \brief The clock (second chance) algorithm */
+
+//-----------------------------------------------------------------
+
+
+
+class ClockPolicy : public ReplacementPolicy {
+
+public:
+
+  ClockPolicy(PhysicalMemManager *mem);
+
+  int ChooseVictim();
+
+
+
+private:
+
+  int hand;			//!< Last page evicted
+
+};
+
+
+
+//-----------------------------------------------------------------
+
+/*! \brief The two-handed clock algorithm */
+
+//-----------------------------------------------------------------
+
+
+
+class TwoHandedClockPolicy : public ReplacementPolicy {
+
+public:
+
+  TwoHandedClockPolicy(PhysicalMemManager *mem);
+
+  int ChooseVictim();
+
+
+
+private:
+
+  int hand;			//!< Back hand, evicting pages
+
+  int spread;			//!< Distance from the back hand to the front one
+
+};
+
+
+
+//-----------------------------------------------------------------
+
+/*! \brief The WSClock algorithm */
+
+//-----------------------------------------------------------------
+
+
+
+class WSClockPolicy : public ReplacementPolicy {
+
+public:
+
+  WSClockPolicy(PhysicalMemManager *mem);
+
+  ~WSClockPolicy();
+
+  int ChooseVictim();
+
+  void PageLoaded(long numPage, AddrSpace *owner, int virtualPage);
+
+
+
+private:
+
+  int hand;			//!< Last page evicted
+
+  Time *lastUse;		//!< Time of the last reference seen, per page
+
+};
+
+
+
+//-----------------------------------------------------------------
+
+/*! \brief LRU approximation with aging counters */
+
+//-----------------------------------------------------------------
+
+
+
+class AgingPolicy : public ReplacementPolicy {
+
+public:
+
+  AgingPolicy(PhysicalMemManager *mem);
+
+  ~AgingPolicy();
+
+  int ChooseVictim();
+
+  void PageLoaded(long numPage, AddrSpace *owner, int virtualPage);
+
+
+
+private:
+
+  int hand;			//!< Last page evicted, to break the ties
+
+  uint8_t *age;			//!< Aging counter of each page
+
+};
+
+
+
+//-----------------------------------------------------------------
+
+/*! \brief A simplified CLOCK-Pro
+
+
+
+   Resident pages are hot or cold. Cold pages are in a test period
+
+   after being loaded: a cold page referenced during its test period
+
+   becomes hot. A cold page evicted during its test period is
+
+   remembered as non-resident, and becomes hot if it is loaded again
+
+   soon enough. The target number of cold pages grows on such
+
+   faults, and shrinks when test periods end without a reference.
+
+*/
+
+//-----------------------------------------------------------------
+
+
+
+class ClockProPolicy : public ReplacementPolicy {
+
+public:
+
+  ClockProPolicy(PhysicalMemManager *mem);
+
+  ~ClockProPolicy();
+
+  int ChooseVictim();
+
+  void PageLoaded(long numPage, AddrSpace *owner, int virtualPage);
+
+  void PageFreed(long numPage);
+
+
+
+private:
+
+  int RunHandCold();		//!< Finds a cold page to evict
+
+  bool RunHandHot();		//!< Demotes one hot page to cold
+
+  void EndTest();		//!< A test period ended without a reference
+
+  void Forget(int index);	//!< Removes an entry of the non-resident pages
+
+
+
+  //! Cold page evicted during its test period. Its address space
+
+  //! may have been deleted since: a new one allocated at the same
+
+  //! address only makes a wrong guess on the hotness of a page
+
+  struct nonresident_c {
+
+    AddrSpace *owner;		//!< Address space of the page
+
+    int virtualPage;		//!< Virtual page in this address space
+
+  };
+
+
+
+  int handCold;			//!< Hand looking for a victim among cold pages
+
+  int handHot;			//!< Hand demoting the hot pages
+
+  bool *hot;			//!< true if the page is hot
+
+  bool *test;			//!< true if the cold page is in its test period
+
+  int numHot;			//!< Number of hot pages
+
+  int coldTarget;		//!< Target number of cold pages
+
+  struct nonresident_c *nonResident; //!< Non-resident pages, oldest first
+
+  int numNonResident;		//!< Number of non-resident pages remembered
+
+};
+
+
+
+#endif // __REPLACEMENT_H
+
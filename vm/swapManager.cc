@@ -34,6 +34,8 @@
 
 #include "vm/swapManager.h"
 
+#include "vm/compressedSwap.h"
+
 
 
 //-----------------------------------------------------------------
@@ -56,12 +58,20 @@ SwapManager::SwapManager() {
 
 
 
-  swap_disk = new DriverDisk((char*)"sem swap disk",(char*)"lock swap disk",
-
-			     g_machine->diskSwap);
+  swap_disk = new DriverDisk((char*)"swap disk",g_machine->diskSwap);
 
   page_flags = new BitMap(NUM_SECTORS);
 
+  ref_count = new int[NUM_SECTORS];
+
+  for (int i=0;i<NUM_SECTORS;i++) ref_count[i] = 0;
+
+  pool = NULL;
+
+  if (g_cfg->CompressedSwapSize > 0)
+
+    pool = new CompressedSwap(g_cfg->CompressedSwapSize, swap_disk);
+
 
 
 }
@@ -86,8 +96,12 @@ SwapManager::~SwapManager() {
 
 
 
+  delete pool;
+
   delete page_flags;
 
+  delete [] ref_count;
+
   delete swap_disk;
 
 
@@ -130,6 +144,8 @@ int SwapManager::GetFreePage() {
 
       page_flags->Mark(i);
 
+      ref_count[i] = 1;
+
       return i;
 
     }
@@ -166,6 +182,14 @@ void SwapManager::ReleasePageSwap(int num_sector) {
 
 
 
+  ASSERT(ref_count[num_sector] > 0);
+
+  // The page is still referenced by another address space
+
+  if (--ref_count[num_sector] > 0) return;
+
+
+
   DEBUG('v',(char *)"Swap page %i released for thread \"%s\"\n",num_sector,
 
 	g_current_thread->GetName());
@@ -174,12 +198,68 @@ void SwapManager::ReleasePageSwap(int num_sector) {
 
   page_flags->Clear(num_sector);
 
+  if (pool != NULL)
+
+    pool->Drop(num_sector);
+
 
 
 }
 
 
 
+//-----------------------------------------------------------------
+
+/** Adds a user to a page of the swap area, referenced by one more
+
+ *  page table entry. The page is freed by the last call to
+
+ *  ReleasePageSwap.
+
+ *
+
+ *  \param num_sector: the sector number to share
+
+ */
+
+//-----------------------------------------------------------------
+
+void SwapManager::SharePageSwap(int num_sector) {
+
+
+
+  ASSERT(page_flags->Test(num_sector));
+
+  ref_count[num_sector]++;
+
+}
+
+
+
+//-----------------------------------------------------------------
+
+/** Tells if a page of the swap area is referenced by more than one
+
+ *  page table entry. Such a page must not be overwritten.
+
+ *
+
+ *  \param num_sector: the sector number
+
+ */
+
+//-----------------------------------------------------------------
+
+bool SwapManager::IsSharedPageSwap(int num_sector) {
+
+
+
+  return (ref_count[num_sector] > 1);
+
+}
+
+
+
 //-----------------------------------------------------------------
 
 /** Fill a buffer with the swap information in a specific sector in the swap area
@@ -202,8 +282,14 @@ void SwapManager::GetPageSwap(int num_sector ,char* SwapPage ) {
 
 	g_current_thread->GetName());
 
+  if ((pool != NULL) && pool->Load(num_sector,SwapPage))
+
+    return;
+
   swap_disk->ReadSector(num_sector,SwapPage);
 
+  g_stats->incrSwapReads();
+
 }
 
 
@@ -236,41 +322,31 @@ int SwapManager::PutPageSwap(int num_sector,char *SwapPage) {
 
 
 
-  if (num_sector >= 0) {
+  if (num_sector < 0) {
 
-    DEBUG('v',(char *)"Writing swap page %i for \"%s\"\n",num_sector,
+    num_sector = GetFreePage();
 
-	    g_current_thread->GetName());
+    if (num_sector == -1)
 
-    swap_disk->WriteSector(num_sector,SwapPage);
-
-    return num_sector;
+      return -1;
 
   }
 
-  else {
-
-    int newpage = GetFreePage();
+  DEBUG('v',(char *)"Writing swap page %i for \"%s\"\n",num_sector,
 
-    if (newpage == -1) {
-
-      return -1;
-
-    }
-
-    else {
+	g_current_thread->GetName());
 
-      DEBUG('v',(char *)"Writing swap page %i for \"%s\"\n",newpage,
+  // The page goes to the disk only if the compressed pool refuses it
 
-	    g_current_thread->GetName());
+  if ((pool == NULL) || !pool->Store(num_sector,SwapPage)) {
 
-      swap_disk->WriteSector(newpage,SwapPage);
+    swap_disk->WriteSector(num_sector,SwapPage);
 
-      return newpage;
+    g_stats->incrSwapWrites();
 
-    }
+  }
 
-  }		 
+  return num_sector;
 
 }
 
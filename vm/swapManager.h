@@ -44,6 +44,8 @@ class BitMap;
 
 class OpenFile;
 
+class CompressedSwap;
+
 
 
 //-----------------------------------------------------------------
@@ -54,7 +56,9 @@ class OpenFile;
 
    This class implements data structures for providing a swapping
 
-   mechanism in Nachos.
+   mechanism in Nachos. The pages may be kept compressed in memory
+
+   before they reach the swap disk (see compressedSwap.h).
 
 
 
@@ -66,6 +70,12 @@ class OpenFile;
 
      - release an unused page in the swapping area,
 
+     - share a page of the swapping area between several address
+
+       spaces (after a Fork): a page is freed when its last user
+
+       releases it.
+
 */
 
 //-----------------------------------------------------------------
@@ -162,6 +172,36 @@ public:
 
 
 
+  /** Adds a user to a page of the swap area, referenced by one more
+
+   *  page table entry. The page is freed by the last call to
+
+   *  ReleasePageSwap.
+
+   *
+
+   *  \param num_sector: the sector number to share
+
+   */
+
+  void SharePageSwap(int num_sector);
+
+
+
+  /** Tells if a page of the swap area is referenced by more than one
+
+   *  page table entry. Such a page must not be overwritten.
+
+   *
+
+   *  \param num_sector: the sector number
+
+   */
+
+  bool IsSharedPageSwap(int num_sector);
+
+
+
   /** This method gives access to the swapdisk's driver */
 
   DriverDisk * GetSwapDisk ();   
@@ -184,6 +224,22 @@ private:
 
 
 
+  /** Number of page table entries referencing each sector of the
+
+      swap area */
+
+  int *ref_count;
+
+
+
+  /** Pool of compressed pages in front of the disk, NULL if there is
+
+      none (CompressedSwapSize = 0) */
+
+  CompressedSwap *pool;
+
+
+
   /** Returns the number of a free page in the swap area
 
    *